@@ -33,7 +33,10 @@ int main()
 
     // Every peripheral is held in reset at power-up
     // We need to release io_bank0 from the reset state to be able to use GPIOs
-    reset::release_subsystem_wait(reset::subsystems::io_bank0);
+    if (reset::release_subsystem_wait(reset::subsystems::io_bank0) !=
+        busy_wait::result::ready) {
+        __builtin_trap();
+    }
 
     gpio::pin<platform::pins::gpio25> led0;
     led0.function_select(gpio::functions::sio);
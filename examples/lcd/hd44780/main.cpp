@@ -37,12 +37,19 @@ using namespace drivers::lcd;
 int main()
 {
     // We need watchdog to use timer::delay()
-    clocks::init();
+    // Stop (HardFault) rather than run on a wrong clock when an oscillator,
+    // a PLL or a clock mux does not respond (see busy_wait::statistics())
+    if (!clocks::init()) {
+        __builtin_trap();
+    }
     clocks::watchdog_start(platform::xosc::frequency_khz);
 
     // Every peripheral is held in reset at power-up
     // We need to release io_bank0 from the reset state to be able to use GPIOs
-    reset::release_subsystem_wait(reset::subsystems::io_bank0);
+    if (reset::release_subsystem_wait(reset::subsystems::io_bank0) !=
+        busy_wait::result::ready) {
+        __builtin_trap();
+    }
 
     gpio::pin<platform::pins::gpio25> led0;
     led0.function_select(gpio::functions::sio);
@@ -30,21 +30,33 @@ using namespace std::chrono_literals;
 
 int main()
 {
-    clocks::init();
+    // Stop (HardFault) rather than run on a wrong clock when an oscillator,
+    // a PLL or a clock mux does not respond (see busy_wait::statistics())
+    if (!clocks::init()) {
+        __builtin_trap();
+    }
     clocks::watchdog_start(platform::xosc::frequency_khz);
 
     // For GPIO
-    reset::release_subsystem_wait(reset::subsystems::io_bank0);
+    if (reset::release_subsystem_wait(reset::subsystems::io_bank0) !=
+        busy_wait::result::ready) {
+        __builtin_trap();
+    }
     // For PWM
-    reset::release_subsystem_wait(reset::subsystems::pwm);
+    if (reset::release_subsystem_wait(reset::subsystems::pwm) !=
+        busy_wait::result::ready) {
+        __builtin_trap();
+    }
 
     gpio::pin<platform::pins::gpio25> led0;
 
     // Change PIN function to PWM
     led0.function_select(gpio::functions::pwm);
 
-    // Get the right PWM instance (called a slice) for the specified GPIO pin
-    auto pwm_slice = pwm::from_gpio(led0);
+    // Get the right PWM instance (called a slice) for the specified GPIO pin,
+    // the configuration registers are cached in RAM (the channel level
+    // updates below perform a single store each)
+    auto pwm_slice = pwm::shadowed<decltype(pwm::from_gpio(led0))>{};
     auto pwm_channel = pwm::channel::from_gpio(led0);
     using pwm_channel_t = decltype(pwm_channel);
 
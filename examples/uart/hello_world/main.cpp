@@ -29,20 +29,29 @@ using namespace std::chrono_literals;
 
 int main()
 {
-    clocks::init();
+    // Stop (HardFault) rather than run on a wrong clock when an oscillator,
+    // a PLL or a clock mux does not respond (see busy_wait::statistics())
+    if (!clocks::init()) {
+        __builtin_trap();
+    }
     clocks::watchdog_start(platform::xosc::frequency_khz);
 
     // Every peripheral is held in reset at power-up
     // We need to release io_bank0 from the reset state to be able to use GPIOs
     // In this case - we need to use io_bank0 to change the function of the RX,
     // TX pins
-    reset::release_subsystem_wait(reset::subsystems::io_bank0);
+    if (reset::release_subsystem_wait(reset::subsystems::io_bank0) !=
+        busy_wait::result::ready) {
+        __builtin_trap();
+    }
 
     gpio::pin<platform::pins::gpio0> tx;
     gpio::pin<platform::pins::gpio1> rx;
     rx.function_select(gpio::functions::uart);
     tx.function_select(gpio::functions::uart);
-    uart::uart0::init(9600);
+    if (uart::uart0::init(9600) == 0) {
+        __builtin_trap();
+    }
 
     while (true) {
         uart::uart0::puts("Hello world :-)\r\n");
@@ -0,0 +1,119 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include "clocks.hpp"
+#include "gpio.hpp"
+#include "reset.hpp"
+#include "timer.hpp"
+#include "uart.hpp"
+
+using namespace std::chrono_literals;
+
+constexpr uint32_t baudrate = 921'600;
+constexpr std::size_t total_bytes = 64 * 1024;
+
+static void print_number(uint32_t value)
+{
+    std::array<char, 10> digits{};
+    std::size_t first = digits.size();
+    do {
+        digits[--first] = static_cast<char>('0' + (value % 10));
+        value /= 10;
+    } while (value != 0);
+    uart::uart0::puts(
+      std::string_view{digits.data() + first, digits.size() - first});
+}
+
+// Sends `total_bytes` and reports the throughput in bytes per second
+template<typename Send>
+static void measure(std::string_view name, Send send)
+{
+    std::array<std::byte, 256> block{};
+    for (std::size_t i = 0; i < block.size(); ++i) {
+        block[i] = static_cast<std::byte>('A' + (i % 26));
+    }
+
+    const auto start = timer::clock::now();
+    for (std::size_t sent = 0; sent < total_bytes; sent += block.size()) {
+        send(std::span<const std::byte>{block});
+    }
+    const auto elapsed = timer::clock::now() - start;
+
+    uart::uart0::puts("\r\n");
+    uart::uart0::puts(name);
+    uart::uart0::puts(": ");
+    print_number(static_cast<uint32_t>(
+      (static_cast<uint64_t>(total_bytes) * 1'000'000) /
+      static_cast<uint64_t>(elapsed.count())));
+    uart::uart0::puts(" B/s\r\n");
+}
+
+int main()
+{
+    // Stop (HardFault) rather than run on a wrong clock when an oscillator,
+    // a PLL or a clock mux does not respond (see busy_wait::statistics())
+    if (!clocks::init()) {
+        __builtin_trap();
+    }
+    clocks::watchdog_start(platform::xosc::frequency_khz);
+
+    if (reset::release_subsystem_wait(reset::subsystems::io_bank0) !=
+        busy_wait::result::ready) {
+        __builtin_trap();
+    }
+
+    gpio::pin<platform::pins::gpio0> tx;
+    gpio::pin<platform::pins::gpio1> rx;
+    rx.function_select(gpio::functions::uart);
+    tx.function_select(gpio::functions::uart);
+    const uint32_t real_baudrate = uart::uart0::init<baudrate>();
+    if (real_baudrate == 0) {
+        __builtin_trap();
+    }
+
+    while (true) {
+        uart::uart0::puts("\r\nBaudrate: ");
+        print_number(real_baudrate);
+        // 8 data bits, odd parity and one stop bit: 11 bits per byte
+        uart::uart0::puts(" (8O1 limit: ");
+        print_number(real_baudrate / 11);
+        uart::uart0::puts(" B/s)\r\n");
+
+        measure("putc (flag check per byte)",
+                [](std::span<const std::byte> data) {
+                    for (const std::byte value : data) {
+                        uart::uart0::putc(static_cast<char>(value));
+                    }
+                });
+        measure("write (32 bytes per flag check)",
+                [](std::span<const std::byte> data) {
+                    uart::uart0::write(data);
+                });
+        timer::delay(3s);
+    }
+}
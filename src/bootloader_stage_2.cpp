@@ -20,6 +20,7 @@
  */
 
 #include "bitops.hpp"
+#include "block_store.hpp"
 #include "pads.hpp"
 #include "rp2040.hpp"
 
@@ -38,24 +39,6 @@ static inline void configure_pads()
                                pads::input::default_after_reset,
                                pads::output::default_after_reset);
 
-    //
-    // pads::qspi_sd0::pad_reg::set_value(sd_value);
-    // pads::qspi_sd1::pad_reg::set_value(sd_value);
-    // pads::qspi_sd2::pad_reg::set_value(sd_value);
-    // pads::qspi_sd3::pad_reg::set_value(sd_value);
-    //
-    // unfortunetly - the above core requires further optimization;
-    //       GCC generates multiple LDR + STR instructions;
-    //       we can do better:
-    //
-    //       str rX [reg_with_QSPI_BASE, SD0_OFFSET]
-    //       str rX [reg_with_QSPI_BASE, SD1_OFFSET]
-    //       str rX [reg_with_QSPI_BASE, SD2_OFFSET]
-    //       str rX [reg_with_QSPI_BASE, SD3_OFFSET]
-    //
-    //       (solved with 'asm volatile'):
-    //
-
     const auto sd_value = pads::qspi_sd0::calculate_value(
       pads::slew_rate::default_after_reset,
       pads::schmitt_trigger::disable,
@@ -65,24 +48,18 @@ static inline void configure_pads()
       pads::input::default_after_reset,
       pads::output::default_after_reset);
 
-    constexpr auto qspi_base = pads::qspi::base_addr;
-    constexpr auto qspi_sd0_offset = pads::qspi_sd0::pad_reg::offset;
-    constexpr auto qspi_sd1_offset = pads::qspi_sd1::pad_reg::offset;
-    constexpr auto qspi_sd2_offset = pads::qspi_sd2::pad_reg::offset;
-    constexpr auto qspi_sd3_offset = pads::qspi_sd3::pad_reg::offset;
-
-    asm volatile("str %[value], [%[base], %[offset0]]\n\t"
-                 "str %[value], [%[base], %[offset1]]\n\t"
-                 "str %[value], [%[base], %[offset2]]\n\t"
-                 "str %[value], [%[base], %[offset3]]\n\t"
-                 :
-                 : [value] "r"(sd_value),
-                   [base] "r"(qspi_base),
-                   [offset0] "i"(qspi_sd0_offset),
-                   [offset1] "i"(qspi_sd1_offset),
-                   [offset2] "i"(qspi_sd2_offset),
-                   [offset3] "i"(qspi_sd3_offset)
-                 :);
+    // A single load of the QSPI pads base followed by:
+    //
+    //       str rX [reg_with_QSPI_BASE, SD0_OFFSET]
+    //       str rX [reg_with_QSPI_BASE, SD1_OFFSET]
+    //       str rX [reg_with_QSPI_BASE, SD2_OFFSET]
+    //       str rX [reg_with_QSPI_BASE, SD3_OFFSET]
+    //
+    using qspi_data_pads = hwio::block_store<pads::qspi_sd0::pad_reg,
+                                             pads::qspi_sd1::pad_reg,
+                                             pads::qspi_sd2::pad_reg,
+                                             pads::qspi_sd3::pad_reg>;
+    qspi_data_pads::store_same(sd_value);
 }
 
 enum class read_commands : uint8_t
@@ -23,6 +23,7 @@
 #define BITOPS_HPP
 
 #include <concepts>
+#include <cstdint>
 #include <type_traits>
 #include <utility>
 
@@ -94,4 +95,23 @@ constexpr auto read_bits(const auto& lhs,
     return (lhs & bitmask(bit_position...));
 }
 
+namespace detail {
+constexpr uint8_t de_bruijn_bit_positions[32] = {
+  0,  1,  28, 2,  29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4,  8,
+  31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6,  11, 5,  10, 9};
+}
+
+// std::countr_zero() calls a libgcc helper on ARMv6-M (no CLZ, no RBIT): the
+// lowest set bit is isolated and mapped with a de Bruijn sequence instead
+constexpr unsigned int countr_zero(uint32_t value)
+{
+    constexpr uint32_t de_bruijn_sequence = 0x077cb531;
+    if (value == 0) {
+        return 32;
+    }
+    return detail::de_bruijn_bit_positions[((value & -value) *
+                                            de_bruijn_sequence) >>
+                                           27];
+}
+
 #endif
@@ -0,0 +1,195 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef BLOCK_STORE_HPP
+#define BLOCK_STORE_HPP
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "hwio.hpp"
+
+namespace hwio {
+
+// Writes to many neighbouring registers using a single base address:
+//
+//       ldr  rB, =BASE
+//       str  rX, [rB, #OFFSET0]
+//       str  rY, [rB, #OFFSET1]
+//       ...
+//
+// or (when the registers are contiguous and the values differ):
+//
+//       ldr   rB, =BASE
+//       stmia rB!, {r0, r1, ...}
+//
+// GCC (as for today) reloads the absolute address of every volatile
+// register, so this is the only way to get the dense code without writing
+// the assembly by hand.
+//
+// Thumb-1 (ARMv6-M) limits the immediate offset of STR to 0..124 (word
+// aligned), this is verified at compile time.
+//
+// Registers using a backend other than hwio::mmio fall back to a sequence of
+// set_value() calls.
+template<hwio_reg... Reg>
+class block_store
+{
+  public:
+    using reg_addr_t = std::common_type_t<typename Reg::reg_addr_t...>;
+    using reg_value_t = std::common_type_t<typename Reg::reg_value_t...>;
+
+    static_assert(sizeof...(Reg) > 0, "Empty list of registers");
+
+    static constexpr reg_addr_t base = std::min({Reg::addr...});
+    static constexpr std::array<reg_addr_t, sizeof...(Reg)> offsets{
+      (Reg::addr - base)...};
+
+    static_assert(std::ranges::all_of(offsets,
+                                      [](reg_addr_t offset) {
+                                          return offset <= 124 &&
+                                                 offset % 4 == 0;
+                                      }),
+                  "Registers must be word aligned and placed within 124 "
+                  "bytes from the lowest one");
+
+    static constexpr bool is_mmio =
+      (std::same_as<typename Reg::backend, mmio> && ...);
+
+    static constexpr bool is_contiguous = [] {
+        for (std::size_t i = 0; i < offsets.size(); ++i) {
+            if (offsets[i] != i * sizeof(reg_value_t)) {
+                return false;
+            }
+        }
+        return true;
+    }();
+
+    // Store a separate value to each register (in order of the Reg list)
+    static void store(typename Reg::reg_value_t... value)
+    {
+        constexpr std::size_t count = sizeof...(Reg);
+        if constexpr (!is_mmio) {
+            (Reg::set_value(value), ...);
+        } else if constexpr (is_contiguous && count >= 2 && count <= 4) {
+            reg_addr_t base_reg = load_base();
+            store_multiple(base_reg, value...);
+        } else {
+            reg_addr_t base_reg = load_base();
+            store_each(base_reg,
+                       std::make_index_sequence<count>{},
+                       static_cast<reg_value_t>(value)...);
+        }
+    }
+
+    // Store the same value to all registers (always STR - STMIA would
+    // require a copy of the value for each register)
+    static void store_same(reg_value_t value)
+    {
+        if constexpr (!is_mmio) {
+            (Reg::set_value(value), ...);
+        } else {
+            reg_addr_t base_reg = load_base();
+            [&]<std::size_t... Index>(std::index_sequence<Index...>) {
+                (store_at<offsets[Index]>(base_reg, value), ...);
+            }(std::make_index_sequence<sizeof...(Reg)>{});
+        }
+    }
+
+  private:
+    static reg_addr_t load_base()
+    {
+        reg_addr_t base_reg = base;
+        // Hide the value from the optimizer, the base address must be
+        // materialized exactly once
+        asm volatile("" : "+l"(base_reg));
+        return base_reg;
+    }
+
+    template<reg_addr_t Offset>
+    static void store_at(reg_addr_t base_reg, reg_value_t value)
+    {
+        asm volatile("str %[value], [%[base], %[offset]]\n\t"
+                     :
+                     : [value] "l"(value),
+                       [base] "l"(base_reg),
+                       [offset] "i"(Offset)
+                     : "memory");
+    }
+
+    template<std::size_t... Index>
+    static void store_each(reg_addr_t base_reg,
+                           std::index_sequence<Index...>,
+                           auto... value)
+    {
+        (store_at<offsets[Index]>(base_reg, value), ...);
+    }
+
+    static void store_multiple(reg_addr_t base_reg,
+                               reg_value_t value0,
+                               reg_value_t value1)
+    {
+        register reg_value_t r0 asm("r0") = value0;
+        register reg_value_t r1 asm("r1") = value1;
+        asm volatile("stmia %[base]!, {r0, r1}\n\t"
+                     : [base] "+l"(base_reg)
+                     : "r"(r0), "r"(r1)
+                     : "memory");
+    }
+
+    static void store_multiple(reg_addr_t base_reg,
+                               reg_value_t value0,
+                               reg_value_t value1,
+                               reg_value_t value2)
+    {
+        register reg_value_t r0 asm("r0") = value0;
+        register reg_value_t r1 asm("r1") = value1;
+        register reg_value_t r2 asm("r2") = value2;
+        asm volatile("stmia %[base]!, {r0, r1, r2}\n\t"
+                     : [base] "+l"(base_reg)
+                     : "r"(r0), "r"(r1), "r"(r2)
+                     : "memory");
+    }
+
+    static void store_multiple(reg_addr_t base_reg,
+                               reg_value_t value0,
+                               reg_value_t value1,
+                               reg_value_t value2,
+                               reg_value_t value3)
+    {
+        register reg_value_t r0 asm("r0") = value0;
+        register reg_value_t r1 asm("r1") = value1;
+        register reg_value_t r2 asm("r2") = value2;
+        register reg_value_t r3 asm("r3") = value3;
+        asm volatile("stmia %[base]!, {r0, r1, r2, r3}\n\t"
+                     : [base] "+l"(base_reg)
+                     : "r"(r0), "r"(r1), "r"(r2), "r"(r3)
+                     : "memory");
+    }
+};
+
+}
+
+#endif
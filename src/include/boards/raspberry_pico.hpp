@@ -21,8 +21,32 @@
 
 #include <cstdint>
 
+#include <type_traits>
+
+#include "cortex_m0plus.hpp"
+#include "hwio.hpp"
+#include "hwio_instrumentation.hpp"
+
 namespace board {
 
+// Count and trace every register access (see hwio_instrumentation.hpp), the
+// statistics can be dumped with hwio::instrumentation::dump<access_recorder>
+// and decoded with tools/hwio_trace.py. Disabled - plain memory mapped I/O.
+constexpr bool instrument_register_access = false;
+
+using access_recorder = hwio::instrumentation::recorder<64, 256>;
+
+// TIMER: TIMERAWL (1MHz)
+using access_clock = hwio::instrumentation::register_clock<hwio::mmio,
+                                                           0x40054028>;
+
+using register_backend = std::conditional_t<
+  instrument_register_access,
+  hwio::instrumented<hwio::mmio, access_recorder, access_clock>,
+  hwio::mmio>;
+
+using core = cortex_m0plus::core;
+
 namespace pll {
 constexpr uint32_t common_refdiv = 1UL;
 constexpr uint32_t pll_sys_vco_freq_khz = 1500'000UL;
@@ -0,0 +1,120 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef BUSY_WAIT_HPP
+#define BUSY_WAIT_HPP
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <utility>
+
+#include "systick.hpp"
+
+// Bounded polling of the hardware (reset done, oscillator stable, PLL lock,
+// clock selected...).
+//
+// Every wait is limited by a budget of processor cycles (measured with
+// SysTick) and is accounted for in a small statistics block - a hung
+// peripheral becomes a reportable error and the statistics tell where the
+// time goes (e.g. during the boot).
+namespace busy_wait {
+
+enum class result
+{
+    ready,
+    timeout,
+};
+
+// Call sites recorded in the statistics block
+enum class sites : uint8_t
+{
+    reset_done,
+    xosc_stable,
+    xosc_disabled,
+    pll_lock,
+    clock_selected,
+    dma_done,
+    dma_abort,
+    count,
+};
+
+struct site_statistics
+{
+    uint32_t calls;
+    uint32_t timeouts;
+    uint32_t last_cycles;
+    uint32_t max_cycles;
+};
+
+// ~128ms at 125MHz, ~2.5s when running from ROSC at 6.5MHz
+constexpr uint32_t default_budget = 16'000'000;
+
+namespace detail {
+inline std::array<site_statistics, std::to_underlying(sites::count)>
+  statistics{};
+}
+
+inline const site_statistics& statistics(sites site)
+{
+    return detail::statistics[std::to_underlying(site)];
+}
+
+inline void reset_statistics()
+{
+    detail::statistics = {};
+}
+
+// Polls `ready` until it returns true or `budget` cycles pass. Interrupts
+// taken while waiting count against the budget.
+template<std::predicate Predicate>
+[[nodiscard]] inline result until(sites site,
+                    Predicate&& ready,
+                    uint32_t budget = default_budget)
+{
+    systick::start();
+    uint32_t last = systick::now();
+    uint32_t spent = 0;
+    result outcome = result::ready;
+    while (!ready()) {
+        const uint32_t current = systick::now();
+        spent += systick::elapsed(last, current);
+        last = current;
+        if (spent >= budget) {
+            outcome = result::timeout;
+            break;
+        }
+    }
+    spent += systick::elapsed(last, systick::now());
+
+    auto& stats = detail::statistics[std::to_underlying(site)];
+    ++stats.calls;
+    stats.timeouts += (outcome == result::timeout) ? 1 : 0;
+    stats.last_cycles = spent;
+    stats.max_cycles = std::max(stats.max_cycles, spent);
+    return outcome;
+}
+
+}
+
+#endif
@@ -22,6 +22,7 @@
 #ifndef CLOCKS_HPP
 #define CLOCKS_HPP
 
+#include "busy_wait.hpp"
 #include "reset.hpp"
 #include "rp2040.hpp"
 #include "xosc.hpp"
@@ -85,12 +86,12 @@ class clock
 
     static constexpr void stop()
     {
-        descriptor::ctrl::reset_bits(descriptor::ctrl_bits::enable);
+        descriptor::ctrl::atomic_clear_bits(descriptor::ctrl_bits::enable);
     }
 
     static constexpr void start()
     {
-        descriptor::ctrl::set_bits(descriptor::ctrl_bits::enable);
+        descriptor::ctrl::atomic_set_bits(descriptor::ctrl_bits::enable);
     }
 
     static constexpr bool has_glitchless_mux()
@@ -123,7 +124,7 @@ class clock
     }
 
     template<valid_clock_with_glitchless_mux C = Clock>
-    static constexpr bool configure(C::src src,
+    [[nodiscard]] static constexpr bool configure(C::src src,
                                     Clock::auxsrc auxsrc,
                                     uint32_t src_freq,
                                     uint32_t freq)
@@ -138,14 +139,18 @@ class clock
         }
 
         Clock::ctrl::clear_regions(typename Clock::region_src{});
-        while (!Clock::selected::get_bit(0)) {
-            // wait
+        if (busy_wait::until(busy_wait::sites::clock_selected, [] {
+                return Clock::selected::get_bit(0);
+            }) != busy_wait::result::ready) {
+            return false;
         }
 
         Clock::ctrl::update_regions(typename Clock::region_auxsrc{auxsrc});
         Clock::ctrl::update_regions(typename Clock::region_src{src});
-        while (!is_selected(src)) {
-            // wait
+        if (busy_wait::until(busy_wait::sites::clock_selected, [src] {
+                return is_selected(src);
+            }) != busy_wait::result::ready) {
+            return false;
         }
 
         Clock::div::set_value(div);
@@ -153,7 +158,7 @@ class clock
     }
 
     template<valid_clock_without_glitchless_mux C = Clock>
-    static constexpr bool configure(Clock::auxsrc auxsrc,
+    [[nodiscard]] static constexpr bool configure(Clock::auxsrc auxsrc,
                                     uint32_t src_freq,
                                     uint32_t freq)
     {
@@ -185,78 +190,96 @@ class clock
 
 // TODO: use strong types (something like freq::mhz, freq::hz)
 template<typename P>
-constexpr void pll_init(uint32_t refdiv,
-                        uint32_t vco_freq,
-                        uint32_t post_div,
-                        uint32_t post_div2)
+[[nodiscard]] constexpr busy_wait::result pll_init(uint32_t refdiv,
+                                                   uint32_t vco_freq,
+                                                   uint32_t post_div,
+                                                   uint32_t post_div2)
 {
     namespace pll = platform::pll;
     const uint32_t ref_freq = platform::xosc::frequency_khz * 1000 / refdiv;
     const uint32_t fbdiv = vco_freq / ref_freq;
     reset::reset_subsystem(P::reset_bit);
-    reset::release_subsystem_wait(P::reset_bit);
+    if (reset::release_subsystem_wait(P::reset_bit) !=
+        busy_wait::result::ready) {
+        return busy_wait::result::timeout;
+    }
 
     P::cs::update_regions(pll::cs_region_refdiv{refdiv});
     P::fbdiv_int::update_regions(pll::fbdiv_int_region_value{fbdiv});
 
     P::pwr::reset_bits(pll::pwr_bits::pd, pll::pwr_bits::vcopd);
 
-    while (!P::cs::get_bit(pll::cs_bits::lock)) {
-        // wait for PLL to lock
+    if (busy_wait::until(busy_wait::sites::pll_lock, [] {
+            return P::cs::get_bit(pll::cs_bits::lock);
+        }) != busy_wait::result::ready) {
+        return busy_wait::result::timeout;
     }
 
     P::prim::update_regions(pll::prim_region_postdiv1{post_div},
                             pll::prim_region_postdiv2{post_div2});
 
     P::pwr::reset_bits(pll::pwr_bits::postdivpd);
+    return busy_wait::result::ready;
 }
 
-void init()
+// Returns false as soon as any of the oscillators, PLLs or clock muxes does
+// not respond in time (see busy_wait::statistics())
+[[nodiscard]] bool init()
 {
     using namespace platform::clocks;
     using namespace board::pll;
     using namespace board::clocks;
+    constexpr auto ready = busy_wait::result::ready;
 
-    xosc::init();
+    if (xosc::init() != ready) {
+        return false;
+    }
 
     clock<clk_sys>::switch_away_from_aux_source();
-    while (clk_sys::selected::value() != 0x01) {
-        // wait
+    if (busy_wait::until(busy_wait::sites::clock_selected, [] {
+            return clk_sys::selected::value() == 0x01;
+        }) != ready) {
+        return false;
     }
 
     clock<clk_ref>::switch_away_from_aux_source();
-    while (clk_ref::selected::value() != 0x01) {
-        // wait
+    if (busy_wait::until(busy_wait::sites::clock_selected, [] {
+            return clk_ref::selected::value() == 0x01;
+        }) != ready) {
+        return false;
+    }
+
+    if (pll_init<platform::pll::sys>(common_refdiv,
+                                     pll_sys_vco_freq_khz * 1000,
+                                     pll_sys_postdiv1,
+                                     pll_sys_postdiv2) != ready) {
+        return false;
+    }
+    if (pll_init<platform::pll::usb>(common_refdiv,
+                                     pll_usb_vco_freq_khz * 1000,
+                                     pll_usb_postdiv1,
+                                     pll_usb_postdiv2) != ready) {
+        return false;
     }
 
-    pll_init<platform::pll::sys>(common_refdiv,
-                                 pll_sys_vco_freq_khz * 1000,
-                                 pll_sys_postdiv1,
-                                 pll_sys_postdiv2);
-    pll_init<platform::pll::usb>(common_refdiv,
-                                 pll_usb_vco_freq_khz * 1000,
-                                 pll_usb_postdiv1,
-                                 pll_usb_postdiv2);
-
-    clock<clk_ref>::configure(
-      clk_ref::src::xosc_clksrc,
-      clk_ref::auxsrc::clksrc_pll_usb, // ignored, we use xosc instead of
-                                       // auxsrc
-      platform::xosc::frequency_khz * 1000,
-      platform::xosc::frequency_khz * 1000);
-
-    clock<clk_sys>::configure(clk_sys::src::clksrc_clk_sys_aux,
-                              clk_sys::auxsrc::clksrc_pll_sys,
-                              sys_clk_hz,
-                              sys_clk_hz);
-    clock<clk_usb>::configure(
-      clk_usb::auxsrc::clksrc_pll_usb, usb_clk_hz, usb_clk_hz);
-    clock<clk_adc>::configure(
-      clk_adc::auxsrc::clksrc_pll_usb, usb_clk_hz, usb_clk_hz);
-    clock<clk_rtc>::configure(
-      clk_rtc::auxsrc::clksrc_pll_usb, usb_clk_hz, rtc_clock_hz);
-    clock<clk_peri>::configure(
-      clk_peri::auxsrc::clk_sys, peri_clk_hz, peri_clk_hz);
+    return clock<clk_ref>::configure(
+             clk_ref::src::xosc_clksrc,
+             clk_ref::auxsrc::clksrc_pll_usb, // ignored, we use xosc instead
+                                              // of auxsrc
+             platform::xosc::frequency_khz * 1000,
+             platform::xosc::frequency_khz * 1000) &&
+           clock<clk_sys>::configure(clk_sys::src::clksrc_clk_sys_aux,
+                                     clk_sys::auxsrc::clksrc_pll_sys,
+                                     sys_clk_hz,
+                                     sys_clk_hz) &&
+           clock<clk_usb>::configure(
+             clk_usb::auxsrc::clksrc_pll_usb, usb_clk_hz, usb_clk_hz) &&
+           clock<clk_adc>::configure(
+             clk_adc::auxsrc::clksrc_pll_usb, usb_clk_hz, usb_clk_hz) &&
+           clock<clk_rtc>::configure(
+             clk_rtc::auxsrc::clksrc_pll_usb, usb_clk_hz, rtc_clock_hz) &&
+           clock<clk_peri>::configure(
+             clk_peri::auxsrc::clk_sys, peri_clk_hz, peri_clk_hz);
 }
 
 /**
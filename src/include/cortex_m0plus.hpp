@@ -0,0 +1,110 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef CORTEX_M0PLUS_HPP
+#define CORTEX_M0PLUS_HPP
+
+#include <cstdint>
+
+// Instructions of the Cortex-M0+ core which have no C++ equivalent, selected
+// by the board header (board::core)
+namespace cortex_m0plus {
+
+struct core
+{
+    using interrupt_state_t = std::uint32_t;
+
+    // Masks all interrupts (PRIMASK), returns the previous state
+    static interrupt_state_t save_and_disable_interrupts()
+    {
+        interrupt_state_t primask;
+        asm volatile("mrs %[primask], primask\n\t"
+                     "cpsid i\n\t"
+                     : [primask] "=l"(primask)
+                     :
+                     : "memory");
+        return primask;
+    }
+
+    static void restore_interrupts(interrupt_state_t primask)
+    {
+        asm volatile("msr primask, %[primask]\n\t"
+                     :
+                     : [primask] "l"(primask)
+                     : "memory");
+    }
+
+    static void wait_for_event()
+    {
+        asm volatile("wfe\n\t" ::: "memory");
+    }
+
+    static void wait_for_interrupt()
+    {
+        asm volatile("wfi\n\t" ::: "memory");
+    }
+
+    static void send_event()
+    {
+        asm volatile("sev\n\t" ::: "memory");
+    }
+
+    // The longest delay_cycles() (the loop counter is loaded with MOVS)
+    static constexpr std::uint32_t max_delay_cycles = (255 * 3) + 2;
+
+    // Exactly `Cycles` cycles (code executed from SRAM or the XIP cache):
+    //
+    //       movs  rX, #N     @ 1 cycle
+    //   1:  subs  rX, #1     @ 1 cycle
+    //       bne   1b         @ 2 cycles (1 cycle when not taken)
+    //       nop              @ 0..2 times, 1 cycle each
+    //
+    // which gives 3 * N cycles plus the NOPs.
+    template<std::uint32_t Cycles>
+    static void delay_cycles()
+    {
+        static_assert(Cycles <= max_delay_cycles);
+        constexpr std::uint32_t iterations = Cycles / 3;
+        constexpr std::uint32_t nops = Cycles % 3;
+        if constexpr (iterations > 0) {
+            std::uint32_t counter;
+            asm volatile("movs %[counter], %[iterations]\n"
+                         "1:\n\t"
+                         "subs %[counter], #1\n\t"
+                         "bne 1b\n\t"
+                         : [counter] "=&l"(counter)
+                         : [iterations] "I"(iterations)
+                         : "cc");
+        }
+        if constexpr (nops > 0) {
+            asm volatile(".rept %c[nops]\n\t"
+                         "nop\n\t"
+                         ".endr\n\t"
+                         :
+                         : [nops] "i"(nops));
+        }
+    }
+};
+
+}
+
+#endif
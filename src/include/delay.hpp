@@ -19,8 +19,13 @@
  *
  */
 
+#ifndef DELAY_HPP
+#define DELAY_HPP
+
 #include <cstdint>
 
+#include "systick.hpp"
+
 static inline void delay(uint64_t num)
 {
     volatile uint64_t counter = num;
@@ -29,3 +34,38 @@ static inline void delay(uint64_t num)
     }
 }
 
+// Busy-waits for `Cycles` of the processor clock. Delays up to
+// board::core::max_delay_cycles (767) are an exact-count loop (see
+// board::core). Longer ones poll SysTick and last at least `Cycles`: they
+// overshoot by up to one iteration of the poll loop (about 15 cycles) plus
+// the systick::start() check on entry. The time spent in interrupts counts,
+// but an interrupt still running at the deadline extends the delay.
+template<uint32_t Cycles>
+static inline void delay_cycles()
+{
+    if constexpr (Cycles <= board::core::max_delay_cycles) {
+        board::core::delay_cycles<Cycles>();
+    } else {
+        systick::delay_cycles(Cycles);
+    }
+}
+
+consteval uint64_t cycles_for_ns(uint64_t nanoseconds)
+{
+    constexpr uint64_t ns_per_second = 1'000'000'000;
+    return ((nanoseconds * board::clocks::sys_clk_hz) + ns_per_second - 1) /
+           ns_per_second;
+}
+
+// At least `Nanoseconds` (rounded up to the next cycle of clk_sys)
+template<uint64_t Nanoseconds>
+static inline void delay_ns()
+{
+    constexpr uint64_t cycles = cycles_for_ns(Nanoseconds);
+    static_assert(cycles <= UINT32_MAX,
+                  "Too long for a busy-wait, use timer::sleep_for()");
+    delay_cycles<static_cast<uint32_t>(cycles)>();
+}
+
+#endif
+
@@ -0,0 +1,173 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef DMA_HPP
+#define DMA_HPP
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+
+#include "block_store.hpp"
+#include "busy_wait.hpp"
+#include "reset.hpp"
+#include "rp2040.hpp"
+
+namespace dma {
+
+using data_size = platform::dma::ctrl_region_data_size_values;
+using treq = platform::dma::ctrl_region_treq_sel_values;
+
+struct transfer_config
+{
+    data_size size = data_size::size_byte;
+    bool increment_read = true;
+    bool increment_write = true;
+    // Pacing of the transfers (data request of a peripheral)
+    treq request = treq::permanent;
+    // Wrap the read (or write) address on a boundary of that many bytes,
+    // 0 - no wrapping
+    uint32_t ring_bytes = 0;
+    bool ring_on_write = false;
+};
+
+// Value of CTRL starting the channel with the given configuration. CHAIN_TO
+// points at the channel itself - chaining to any other channel (including
+// the default channel 0) would restart it when the transfer completes.
+template<typename Ctrl>
+consteval platform::reg_val_t ctrl_value(platform::reg_val_t channel,
+                                         transfer_config config)
+{
+    using namespace platform::dma;
+    const auto ring_size = static_cast<platform::reg_val_t>(
+      config.ring_bytes == 0 ? 0 : std::countr_zero(config.ring_bytes));
+    uint64_t value = Ctrl::regions_to_register_value(
+      ctrl_region_data_size{config.size},
+      ctrl_region_ring_size{ring_size},
+      ctrl_region_treq_sel{config.request},
+      ctrl_region_chain_to{channel});
+    value |= bit_value(ctrl_bits::en);
+    value |= config.increment_read ? bit_value(ctrl_bits::incr_read) : 0;
+    value |= config.increment_write ? bit_value(ctrl_bits::incr_write) : 0;
+    value |= config.ring_on_write ? bit_value(ctrl_bits::ring_sel) : 0;
+    return static_cast<platform::reg_val_t>(value);
+}
+
+// Bus address of a buffer
+inline platform::reg_val_t address_of(const volatile void* pointer)
+{
+    return static_cast<platform::reg_val_t>(
+      reinterpret_cast<std::uintptr_t>(pointer));
+}
+
+// The DMA is held in reset at power-up
+[[nodiscard]] inline busy_wait::result init()
+{
+    return reset::release_subsystem_wait(reset::subsystems::dma);
+}
+
+template<platform::reg_val_t Channel>
+class channel
+{
+  public:
+    using registers = platform::dma::channel<Channel>;
+
+    static_assert(Channel < 12, "The DMA has twelve channels");
+
+    // Programs all four registers with a single STMIA, the write to
+    // CTRL_TRIG (the last one) starts the channel
+    template<transfer_config Config>
+    static void start(platform::reg_val_t from,
+                      platform::reg_val_t to,
+                      platform::reg_val_t count)
+    {
+        static_assert(Config.ring_bytes == 0 ||
+                        (std::has_single_bit(Config.ring_bytes) &&
+                         Config.ring_bytes <= (1U << 15)),
+                      "The ring must be a power of two, up to 32kB");
+        constexpr auto ctrl =
+          ctrl_value<typename registers::ctrl_trig>(Channel, Config);
+        // The data written to the source buffer must not be delayed past
+        // the trigger
+        std::atomic_signal_fence(std::memory_order_release);
+        hwio::block_store<typename registers::read_addr,
+                          typename registers::write_addr,
+                          typename registers::trans_count,
+                          typename registers::ctrl_trig>::store(from,
+                                                                to,
+                                                                count,
+                                                                ctrl);
+    }
+
+    static bool is_busy()
+    {
+        return registers::ctrl_trig::get_bit(
+          platform::dma::ctrl_bits::busy);
+    }
+
+    // Number of transfers left
+    static platform::reg_val_t remaining()
+    {
+        return registers::trans_count::value();
+    }
+
+    // Waits for the in-flight transfers to finish
+    [[nodiscard]] static busy_wait::result abort()
+    {
+        const auto mask = static_cast<platform::reg_val_t>(
+          bit_value(static_cast<platform::dma::chan_abort_bits>(Channel)));
+        platform::dma::chan_abort::set_value(mask);
+        return busy_wait::until(busy_wait::sites::dma_abort, [mask] {
+            return (platform::dma::chan_abort::value() & mask) == 0;
+        });
+    }
+};
+
+// Returned by the functions starting a transfer, the source (or the
+// destination) must stay valid until the transfer is done
+template<platform::reg_val_t Channel>
+class completion
+{
+  public:
+    bool is_done() const
+    {
+        return !channel<Channel>::is_busy();
+    }
+
+    // Long transfers paced by a slow peripheral (e.g. a UART at a low
+    // baudrate) need a budget above the default one
+    [[nodiscard]] busy_wait::result wait(
+      uint32_t budget = busy_wait::default_budget) const
+    {
+        return busy_wait::until(
+          busy_wait::sites::dma_done, [this] { return is_done(); }, budget);
+    }
+
+    platform::reg_val_t remaining() const
+    {
+        return channel<Channel>::remaining();
+    }
+};
+
+}
+
+#endif
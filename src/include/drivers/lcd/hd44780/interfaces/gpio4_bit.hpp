@@ -21,9 +21,8 @@
 
 #ifndef HD44780_GPIO_4BIT_HPP
 #define HD44780_GPIO_4BIT_HPP
-#include <algorithm>
-#include <ranges>
 
+#include "delay.hpp"
 #include "gpio.hpp"
 #include "rp2040.hpp"
 
@@ -59,6 +58,11 @@ class gpio_4bit
     static constexpr auto pin_data6 = gpio::pin<descriptor.data6>{};
     static constexpr auto pin_data7 = gpio::pin<descriptor.data7>{};
 
+    using data_bus = gpio::bus<descriptor.data4,
+                               descriptor.data5,
+                               descriptor.data6,
+                               descriptor.data7>;
+
     static constexpr void init_mcu_interface()
     {
         gpio::function_select(gpio::functions::sio,
@@ -123,19 +127,16 @@ class gpio_4bit
         using namespace std::chrono_literals;
         delay(50us);
         pin_enable.set_high();
-        delay(5us);
+        delay_ns<5000>();
         pin_enable.set_low();
     }
 
     static constexpr void delay(std::chrono::microseconds delay)
     {
         using namespace std::chrono_literals;
-        timer::delay(delay);
+        timer::sleep_for(delay);
     }
 
-    // TODO: Optimize to use a single call to the gpio::set_high() function.
-    //       Should be possible by converting std::array into a tuple using
-    //       std::make_index_sequence
     static constexpr void send_nibble(bool is_instruction, uint8_t data)
     {
         if (is_instruction) {
@@ -143,27 +144,7 @@ class gpio_4bit
         } else {
             pin_register_select.set_high();
         }
-        gpio::set_low(pin_data4, pin_data5, pin_data6, pin_data7);
-
-        constexpr std::array pins{pin_data4.pin_no,
-                                  pin_data5.pin_no,
-                                  pin_data6.pin_no,
-                                  pin_data7.pin_no};
-
-        auto is_high = [&data](const auto& bit_pos_and_pin) -> bool {
-            const auto& [bit_position, pin] = bit_pos_and_pin;
-            return read_bits(data, bit_position);
-        };
-
-        constexpr auto set_pin_high = [](const platform::pins pin) {
-            gpio::set_high(pin);
-        };
-
-        auto pins_to_set = std::views::enumerate(pins) |
-                           std::views::filter(is_high) |
-                           std::views::elements<1>;
-
-        std::ranges::for_each(pins_to_set, set_pin_high);
+        data_bus::write(data);
 
         enable();
     }
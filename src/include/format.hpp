@@ -0,0 +1,557 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef FORMAT_HPP
+#define FORMAT_HPP
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+// Heap-free subset of std::format/std::print:
+//
+//     format::print(uart::uart0_tag, "t={} id={:08x}\r\n", ticks, id);
+//
+// Format strings are parsed and checked against the arguments at compile
+// time. Replacement fields: {} or {:[0][width][type]} with the types d, x,
+// X, b (integers, characters, booleans), c (characters) and s (strings,
+// booleans). {{ and }} stand for the braces.
+//
+// Arguments: integers up to 32 bits, char, bool, strings and decimal fixed
+// point numbers (format::fixed). The arguments are type-erased, so all
+// print() calls share one implementation; the text goes through a 32 byte
+// buffer on the stack straight to the sink.
+namespace format {
+
+// Decimal fixed point number: fixed<2>{-1234} is printed as -12.34
+template<unsigned int Decimals>
+struct fixed
+{
+    static_assert(Decimals > 0 && Decimals < 10);
+    static constexpr unsigned int decimals = Decimals;
+    int32_t value;
+};
+
+template<typename T>
+concept sink = requires(std::string_view text) { T::puts(text); };
+
+namespace detail {
+
+template<typename T>
+constexpr bool is_fixed = false;
+
+template<unsigned int Decimals>
+constexpr bool is_fixed<fixed<Decimals>> = true;
+
+enum class kind : uint8_t
+{
+    unsigned_integer,
+    signed_integer,
+    character,
+    boolean,
+    string,
+    fixed_point,
+};
+
+template<typename T>
+consteval kind kind_of()
+{
+    using value_t = std::remove_cvref_t<T>;
+    if constexpr (std::same_as<value_t, bool>) {
+        return kind::boolean;
+    } else if constexpr (std::same_as<value_t, char>) {
+        return kind::character;
+    } else if constexpr (std::integral<value_t>) {
+        static_assert(sizeof(value_t) <= sizeof(uint32_t),
+                      "64-bit integers are not supported (no divide "
+                      "instruction)");
+        return std::is_signed_v<value_t> ? kind::signed_integer
+                                         : kind::unsigned_integer;
+    } else if constexpr (is_fixed<value_t>) {
+        return kind::fixed_point;
+    } else {
+        static_assert(std::convertible_to<const value_t&, std::string_view>,
+                      "Unsupported argument type");
+        return kind::string;
+    }
+}
+
+struct spec
+{
+    char type = 0;
+    uint8_t width = 0;
+    bool zero_pad = false;
+};
+
+// Not defined, reaching it while parsing a format string (at compile time)
+// fails the compilation
+void invalid_format_string(const char* reason);
+
+consteval bool accepts(kind argument, char type)
+{
+    if (type == 0) {
+        return true;
+    }
+    switch (argument) {
+        case kind::unsigned_integer:
+        case kind::signed_integer:
+            return type == 'd' || type == 'x' || type == 'X' || type == 'b';
+        case kind::character:
+            return type == 'c' || type == 'd' || type == 'x' || type == 'X' ||
+                   type == 'b';
+        case kind::boolean:
+            return type == 's' || type == 'd' || type == 'x' || type == 'X' ||
+                   type == 'b';
+        case kind::string:
+            return type == 's';
+        case kind::fixed_point:
+            return type == 'd';
+    }
+    return false;
+}
+
+// Parses "[0][width][type]"
+consteval spec parse_spec(std::string_view text)
+{
+    spec result;
+    std::size_t position = 0;
+    if (position < text.size() && text[position] == '0') {
+        result.zero_pad = true;
+        ++position;
+    }
+    unsigned int width = 0;
+    while (position < text.size() && text[position] >= '0' &&
+           text[position] <= '9') {
+        width = width * 10 + static_cast<unsigned int>(text[position] - '0');
+        if (width > 32) {
+            invalid_format_string("The width is limited to 32");
+        }
+        ++position;
+    }
+    result.width = static_cast<uint8_t>(width);
+    if (position < text.size()) {
+        result.type = text[position++];
+    }
+    if (position != text.size()) {
+        invalid_format_string("Invalid replacement field");
+    }
+    return result;
+}
+
+struct argument
+{
+    kind type;
+    uint8_t decimals;
+    // The value of integers (as uint32_t), the size of strings
+    uint32_t value;
+    const char* text;
+};
+
+template<typename T>
+constexpr argument make_argument(const T& value)
+{
+    constexpr kind type = kind_of<T>();
+    if constexpr (type == kind::string) {
+        const std::string_view text = value;
+        return {type, 0, static_cast<uint32_t>(text.size()), text.data()};
+    } else if constexpr (type == kind::character) {
+        // Characters are printed as unsigned numbers ({:d}, {:x}), whatever
+        // the signedness of char
+        return {type, 0, static_cast<unsigned char>(value), nullptr};
+    } else {
+        return {type, 0, static_cast<uint32_t>(value), nullptr};
+    }
+}
+
+template<unsigned int Decimals>
+constexpr argument make_argument(const fixed<Decimals>& value)
+{
+    return {kind::fixed_point,
+            static_cast<uint8_t>(Decimals),
+            static_cast<uint32_t>(value.value),
+            nullptr};
+}
+
+}
+
+template<typename... Args>
+class basic_format_string
+{
+  public:
+    template<std::size_t Size>
+    consteval basic_format_string(const char (&text)[Size])
+      : m_text(text, Size - 1)
+    {
+        constexpr std::array<detail::kind, sizeof...(Args)> kinds{
+          detail::kind_of<Args>()...};
+        std::size_t index = 0;
+        std::size_t position = 0;
+        while (position < m_text.size()) {
+            const char current = m_text[position];
+            const bool escaped = position + 1 < m_text.size() &&
+                                 m_text[position + 1] == current;
+            if (current == '}') {
+                if (!escaped) {
+                    invalid_format_string("Unmatched '}'");
+                }
+                position += 2;
+            } else if (current != '{') {
+                ++position;
+            } else if (escaped) {
+                position += 2;
+            } else {
+                const auto end = m_text.find('}', position);
+                if (end == std::string_view::npos) {
+                    invalid_format_string("Unmatched '{'");
+                }
+                if (index == sizeof...(Args)) {
+                    invalid_format_string("Not enough arguments");
+                }
+                auto field = m_text.substr(position + 1, end - position - 1);
+                if (!field.empty()) {
+                    if (field[0] != ':') {
+                        invalid_format_string("Positional arguments are "
+                                              "not supported");
+                    }
+                    m_specs[index] = detail::parse_spec(field.substr(1));
+                }
+                if (!detail::accepts(kinds[index], m_specs[index].type)) {
+                    invalid_format_string("Invalid type for the argument");
+                }
+                ++index;
+                position = end + 1;
+            }
+        }
+        if (index != sizeof...(Args)) {
+            invalid_format_string("Too many arguments");
+        }
+    }
+
+    constexpr std::string_view text() const
+    {
+        return m_text;
+    }
+
+    constexpr std::span<const detail::spec> specs() const
+    {
+        return m_specs;
+    }
+
+  private:
+    static void invalid_format_string(const char* reason)
+    {
+        detail::invalid_format_string(reason);
+    }
+
+    std::string_view m_text;
+    std::array<detail::spec, sizeof...(Args)> m_specs{};
+};
+
+template<typename... Args>
+using format_string = basic_format_string<std::type_identity_t<Args>...>;
+
+namespace detail {
+
+// Two ASCII digits of every number from 0 to 99
+constexpr auto digit_pairs = [] {
+    std::array<char, 200> pairs{};
+    for (std::size_t i = 0; i < 100; ++i) {
+        pairs[i * 2] = static_cast<char>('0' + (i / 10));
+        pairs[(i * 2) + 1] = static_cast<char>('0' + (i % 10));
+    }
+    return pairs;
+}();
+
+// Upper 32 bits of a 32x32 bit product. MULS of the Cortex-M0+ returns the
+// lower 32 bits only - four 16x16 bit products avoid a libgcc call.
+constexpr uint32_t multiply_high(uint32_t lhs, uint32_t rhs)
+{
+    const uint32_t lhs_lo = lhs & 0xffff;
+    const uint32_t lhs_hi = lhs >> 16;
+    const uint32_t rhs_lo = rhs & 0xffff;
+    const uint32_t rhs_hi = rhs >> 16;
+    const uint32_t lo_lo = lhs_lo * rhs_lo;
+    const uint32_t hi_lo = lhs_hi * rhs_lo;
+    const uint32_t lo_hi = lhs_lo * rhs_hi;
+    const uint32_t cross = (lo_lo >> 16) + (hi_lo & 0xffff) + lo_hi;
+    return (lhs_hi * rhs_hi) + (hi_lo >> 16) + (cross >> 16);
+}
+
+// value / 100 without a divide instruction (exact for all 32-bit values)
+constexpr uint32_t divide_by_100(uint32_t value)
+{
+    if (value < 43699) {
+        return (value * 5243) >> 19;
+    }
+    return multiply_high(value, 0x51eb851f) >> 5;
+}
+
+// Writes the digits backwards, ending at `end`
+//
+// @return the first digit
+inline char* to_decimal(char* end, uint32_t value)
+{
+    while (value >= 100) {
+        const uint32_t quotient = divide_by_100(value);
+        const uint32_t pair = (value - (quotient * 100)) * 2;
+        *--end = digit_pairs[pair + 1];
+        *--end = digit_pairs[pair];
+        value = quotient;
+    }
+    if (value >= 10) {
+        *--end = digit_pairs[(value * 2) + 1];
+        *--end = digit_pairs[value * 2];
+    } else {
+        *--end = static_cast<char>('0' + value);
+    }
+    return end;
+}
+
+inline char* to_base(char* end,
+                     uint32_t value,
+                     unsigned int bits_per_digit,
+                     bool uppercase)
+{
+    const char* digits =
+      uppercase ? "0123456789ABCDEF" : "0123456789abcdef";
+    const uint32_t mask = (1U << bits_per_digit) - 1;
+    do {
+        *--end = digits[value & mask];
+        value >>= bits_per_digit;
+    } while (value != 0);
+    return end;
+}
+
+class output
+{
+  public:
+    using sink_t = void (*)(std::string_view);
+
+    // Without a sink the text is truncated to the size of the buffer
+    constexpr output(std::span<char> buffer, sink_t sink = nullptr)
+      : m_buffer(buffer)
+      , m_sink(sink)
+    {
+    }
+
+    void put(char character)
+    {
+        if (m_used == m_buffer.size()) {
+            if (m_sink == nullptr) {
+                return;
+            }
+            flush();
+        }
+        m_buffer[m_used++] = character;
+        ++m_total;
+    }
+
+    void put(char character, std::size_t count)
+    {
+        while (count-- > 0) {
+            put(character);
+        }
+    }
+
+    void write(std::string_view text)
+    {
+        for (const char character : text) {
+            put(character);
+        }
+    }
+
+    void flush()
+    {
+        if (m_sink != nullptr && m_used > 0) {
+            m_sink({m_buffer.data(), m_used});
+        }
+        m_used = 0;
+    }
+
+    // Number of characters written (stored in the buffer)
+    std::size_t total() const
+    {
+        return m_total;
+    }
+
+  private:
+    std::span<char> m_buffer;
+    sink_t m_sink;
+    std::size_t m_used = 0;
+    std::size_t m_total = 0;
+};
+
+inline void write_padded(output& out,
+                         std::string_view text,
+                         const spec& field)
+{
+    out.write(text);
+    if (field.width > text.size()) {
+        out.put(' ', field.width - text.size());
+    }
+}
+
+inline void write_number(output& out, const spec& field, const argument& arg)
+{
+    // 32 binary digits
+    std::array<char, 32> digits;
+    char* const end = digits.data() + digits.size();
+    uint32_t magnitude = arg.value;
+    bool negative = false;
+    if ((arg.type == kind::signed_integer || arg.type == kind::fixed_point) &&
+        static_cast<int32_t>(arg.value) < 0) {
+        negative = true;
+        magnitude = 0U - magnitude;
+    }
+
+    char* begin;
+    switch (field.type) {
+        case 'x':
+        case 'X':
+            begin = to_base(end, magnitude, 4, field.type == 'X');
+            break;
+        case 'b':
+            begin = to_base(end, magnitude, 1, false);
+            break;
+        default:
+            begin = to_decimal(end, magnitude);
+            break;
+    }
+    // At least one digit in front of the decimal point
+    while (end - begin <= arg.decimals) {
+        *--begin = '0';
+    }
+
+    const auto count = static_cast<std::size_t>(end - begin);
+    const std::size_t length =
+      count + (negative ? 1 : 0) + (arg.decimals > 0 ? 1 : 0);
+    const std::size_t padding =
+      field.width > length ? field.width - length : 0;
+    if (!field.zero_pad) {
+        out.put(' ', padding);
+    }
+    if (negative) {
+        out.put('-');
+    }
+    if (field.zero_pad) {
+        out.put('0', padding);
+    }
+    const std::size_t integral = count - arg.decimals;
+    out.write({begin, integral});
+    if (arg.decimals > 0) {
+        out.put('.');
+        out.write({begin + integral, arg.decimals});
+    }
+}
+
+inline void write_argument(output& out,
+                           const spec& field,
+                           const argument& arg)
+{
+    switch (arg.type) {
+        case kind::string:
+            write_padded(out, {arg.text, arg.value}, field);
+            return;
+        case kind::character:
+            if (field.type == 0 || field.type == 'c') {
+                const char character = static_cast<char>(arg.value);
+                write_padded(out, {&character, 1}, field);
+                return;
+            }
+            break;
+        case kind::boolean:
+            if (field.type == 0 || field.type == 's') {
+                write_padded(out, arg.value ? "true" : "false", field);
+                return;
+            }
+            break;
+        default:
+            break;
+    }
+    write_number(out, field, arg);
+}
+
+// The common (not templated) part of all print() and format_to() calls
+inline void vformat(output& out,
+                    std::string_view text,
+                    std::span<const spec> specs,
+                    std::span<const argument> args)
+{
+    std::size_t index = 0;
+    std::size_t position = 0;
+    while (position < text.size()) {
+        const char current = text[position++];
+        if (current == '}') {
+            // Escaped, checked at compile time
+            ++position;
+        } else if (current == '{') {
+            if (text[position] == '{') {
+                ++position;
+            } else {
+                position = text.find('}', position) + 1;
+                write_argument(out, specs[index], args[index]);
+                ++index;
+                continue;
+            }
+        }
+        out.put(current);
+    }
+}
+
+}
+
+// Writes the text to the sink (e.g. uart::uart0_tag)
+template<sink Sink, typename... Args>
+void print(const Sink&, format_string<Args...> fmt, const Args&... args)
+{
+    const std::array<detail::argument, sizeof...(Args)> erased{
+      detail::make_argument(args)...};
+    std::array<char, 32> buffer;
+    detail::output out{buffer, [](std::string_view text) {
+                           Sink::puts(text);
+                       }};
+    detail::vformat(out, fmt.text(), fmt.specs(), erased);
+    out.flush();
+}
+
+// Writes the text to the buffer (truncated to its size)
+//
+// @return number of characters written
+template<typename... Args>
+std::size_t format_to(std::span<char> buffer,
+                      format_string<Args...> fmt,
+                      const Args&... args)
+{
+    const std::array<detail::argument, sizeof...(Args)> erased{
+      detail::make_argument(args)...};
+    detail::output out{buffer};
+    detail::vformat(out, fmt.text(), fmt.specs(), erased);
+    return out.total();
+}
+
+}
+
+#endif
@@ -0,0 +1,444 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef FRAMING_HPP
+#define FRAMING_HPP
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+
+// Binary frames over a byte stream (e.g. UART):
+//
+//     COBS(payload, CRC (little-endian)) 0x00
+//
+// COBS (Consistent Overhead Byte Stuffing) removes all zeros from the data
+// at the cost of one byte per 254, the zero marks the end of a frame - the
+// receiver synchronizes on the next zero after any error.
+//
+// The payload is given as a list of spans (e.g. a header and the data),
+// encoded directly into the output buffer. The receiver decodes frames in
+// place in its buffer and hands out views of the payload.
+//
+// tools/framing.py implements the same format on the host.
+namespace framing {
+
+// Table-driven CRC (one table lookup per byte)
+template<std::unsigned_integral T,
+         T Polynomial,
+         T Initial,
+         T FinalXor,
+         bool Reflected>
+class crc
+{
+  public:
+    using value_type = T;
+
+    static constexpr std::size_t size = sizeof(T);
+
+    constexpr void update(std::span<const std::byte> data)
+    {
+        for (const std::byte value : data) {
+            const auto byte = std::to_integer<uint8_t>(value);
+            if constexpr (Reflected) {
+                m_value = static_cast<T>(table[(m_value ^ byte) & 0xff] ^
+                                         (m_value >> 8));
+            } else {
+                m_value = static_cast<T>(
+                  table[((m_value >> (bits - 8)) ^ byte) & 0xff] ^
+                  (m_value << 8));
+            }
+        }
+    }
+
+    constexpr T value() const
+    {
+        return static_cast<T>(m_value ^ FinalXor);
+    }
+
+    static constexpr T compute(std::span<const std::byte> data)
+    {
+        crc checksum;
+        checksum.update(data);
+        return checksum.value();
+    }
+
+  private:
+    static constexpr unsigned int bits = sizeof(T) * 8;
+
+    static constexpr std::array<T, 256> table = [] {
+        std::array<T, 256> result{};
+        for (unsigned int index = 0; index < result.size(); ++index) {
+            T value = static_cast<T>(Reflected ? index
+                                                : index << (bits - 8));
+            for (int bit = 0; bit < 8; ++bit) {
+                if constexpr (Reflected) {
+                    value = static_cast<T>((value & 1) ? (value >> 1) ^
+                                                           Polynomial
+                                                       : value >> 1);
+                } else {
+                    constexpr T top = static_cast<T>(T{1} << (bits - 1));
+                    value = static_cast<T>((value & top) ? (value << 1) ^
+                                                             Polynomial
+                                                         : value << 1);
+                }
+            }
+            result[index] = value;
+        }
+        return result;
+    }();
+
+    T m_value = Initial;
+};
+
+// CRC-16/CCITT-FALSE
+using crc16 = crc<uint16_t, 0x1021, 0xffff, 0, false>;
+
+// CRC-32 (IEEE 802.3, zlib)
+using crc32 = crc<uint32_t, 0xedb88320, 0xffffffff, 0xffffffff, true>;
+
+template<typename T>
+concept checksum = requires(T checksum, std::span<const std::byte> data) {
+    { T::size } -> std::convertible_to<std::size_t>;
+    checksum.update(data);
+    { checksum.value() } -> std::unsigned_integral;
+};
+
+namespace cobs {
+
+constexpr std::byte delimiter{0};
+
+// Encoded size of `size` bytes (without the delimiter)
+constexpr std::size_t max_encoded_size(std::size_t size)
+{
+    return size + (size / 254) + 1;
+}
+
+// Encodes the data directly into the output, the code byte of each block is
+// filled in once the block ends
+class encoder
+{
+  public:
+    constexpr explicit encoder(std::span<std::byte> output)
+      : m_output(output)
+    {
+        start_block();
+    }
+
+    constexpr void put(std::byte value)
+    {
+        if (!m_open) {
+            start_block();
+        }
+        if (value == delimiter) {
+            end_block();
+            start_block();
+            return;
+        }
+        write(value);
+        if (++m_code == 0xff) {
+            // 254 bytes without a zero
+            end_block();
+        }
+    }
+
+    constexpr void put(std::span<const std::byte> data)
+    {
+        for (const std::byte value : data) {
+            put(value);
+        }
+    }
+
+    // Closes the last block and appends the delimiter
+    //
+    // @return size of the frame, 0 if it does not fit in the output
+    constexpr std::size_t finish()
+    {
+        if (m_open) {
+            end_block();
+        }
+        write(delimiter);
+        return m_size <= m_output.size() ? m_size : 0;
+    }
+
+  private:
+    constexpr void start_block()
+    {
+        m_code_at = m_size;
+        m_code = 1;
+        m_open = true;
+        write(delimiter);
+    }
+
+    constexpr void end_block()
+    {
+        if (m_code_at < m_output.size()) {
+            m_output[m_code_at] = static_cast<std::byte>(m_code);
+        }
+        m_open = false;
+    }
+
+    constexpr void write(std::byte value)
+    {
+        if (m_size < m_output.size()) {
+            m_output[m_size] = value;
+        }
+        ++m_size;
+    }
+
+    std::span<std::byte> m_output;
+    std::size_t m_size = 0;
+    std::size_t m_code_at = 0;
+    uint8_t m_code = 1;
+    bool m_open = true;
+};
+
+// Decodes a frame (without the delimiter) in place, the decoded data is
+// never longer than the encoded one
+//
+// @return false if the frame is malformed
+constexpr bool decode_in_place(std::span<std::byte> frame, std::size_t& size)
+{
+    std::size_t read = 0;
+    std::size_t written = 0;
+    while (read < frame.size()) {
+        const auto code = std::to_integer<std::size_t>(frame[read++]);
+        if (code == 0 || read + code - 1 > frame.size()) {
+            return false;
+        }
+        for (std::size_t i = 1; i < code; ++i) {
+            const std::byte value = frame[read++];
+            if (value == delimiter) {
+                return false;
+            }
+            frame[written++] = value;
+        }
+        if (code != 0xff && read < frame.size()) {
+            frame[written++] = delimiter;
+        }
+    }
+    size = written;
+    return true;
+}
+
+}
+
+// Size of the encoded frame carrying `payload` bytes (with the delimiter)
+template<checksum Crc = crc16>
+constexpr std::size_t max_frame_size(std::size_t payload)
+{
+    return cobs::max_encoded_size(payload + Crc::size) + 1;
+}
+
+// Encodes the parts of the payload (in order) as a single frame
+//
+// @return size of the frame, 0 if it does not fit in the output
+template<checksum Crc = crc16>
+constexpr std::size_t encode_frame(
+  std::span<const std::span<const std::byte>> parts,
+  std::span<std::byte> output)
+{
+    cobs::encoder encoder{output};
+    Crc checksum;
+    for (const auto part : parts) {
+        checksum.update(part);
+        encoder.put(part);
+    }
+    auto value = checksum.value();
+    for (std::size_t i = 0; i < Crc::size; ++i) {
+        encoder.put(static_cast<std::byte>(value & 0xff));
+        value >>= 8;
+    }
+    return encoder.finish();
+}
+
+template<typename T>
+concept sink = requires(std::span<const std::byte> data) { T::write(data); };
+
+// Encodes the frame on the stack and sends it to the sink, e.g.:
+//
+//     framing::send_frame(uart::uart0_tag, std::array{header, data});
+//
+// @return false if the payload is longer than MaxPayload
+template<checksum Crc = crc16, std::size_t MaxPayload = 256, sink Sink>
+bool send_frame(const Sink&, std::span<const std::span<const std::byte>> parts)
+{
+    std::array<std::byte, max_frame_size<Crc>(MaxPayload)> frame;
+    const std::size_t size = encode_frame<Crc>(parts, frame);
+    if (size == 0) {
+        return false;
+    }
+    Sink::write(std::span<const std::byte>{frame.data(), size});
+    return true;
+}
+
+template<typename T>
+concept byte_source = requires(std::span<std::byte> data) {
+    { T::read_some(data) } -> std::same_as<std::size_t>;
+};
+
+struct statistics
+{
+    uint32_t frames = 0;
+    // Valid COBS, wrong CRC
+    uint32_t crc_errors = 0;
+    // Invalid COBS or shorter than the CRC
+    uint32_t malformed = 0;
+    // Frames longer than the buffer (discarded)
+    uint32_t overruns = 0;
+};
+
+// Collects the received bytes and returns the frames:
+//
+//     framing::receiver<crc16, 512> link;
+//     link.receive<uart::uart0>();
+//     std::span<const std::byte> payload;
+//     while (link.next(payload)) { ... }
+//
+// The payload is decoded in place, it stays valid until the next call to
+// receive(), commit() or next().
+template<checksum Crc, std::size_t Size>
+class receiver
+{
+  public:
+    static_assert(Size > Crc::size + 1);
+
+    // Free space for the incoming bytes, see commit()
+    std::span<std::byte> space()
+    {
+        compact();
+        return std::span{m_buffer}.subspan(m_size);
+    }
+
+    void commit(std::size_t count)
+    {
+        m_size += count;
+    }
+
+    // Reads whatever is available from the source
+    //
+    // @return number of bytes received
+    template<byte_source Source>
+    std::size_t receive()
+    {
+        const std::size_t count = Source::read_some(space());
+        commit(count);
+        return count;
+    }
+
+    // @return true if a frame with a valid CRC was found
+    bool next(std::span<const std::byte>& payload)
+    {
+        for (compact(); m_scanned < m_size; compact()) {
+            const auto end = std::find(
+              m_buffer.begin() + static_cast<std::ptrdiff_t>(m_scanned),
+              m_buffer.begin() + static_cast<std::ptrdiff_t>(m_size),
+              cobs::delimiter);
+            const auto length =
+              static_cast<std::size_t>(end - m_buffer.begin());
+            if (length == m_size) {
+                m_scanned = m_size;
+                break;
+            }
+            m_consumed = length + 1;
+            m_scanned = m_consumed;
+            if (std::exchange(m_discarding, false)) {
+                // The tail of a frame longer than the buffer
+                continue;
+            }
+            if (check(std::span{m_buffer}.first(length), payload)) {
+                ++m_statistics.frames;
+                return true;
+            }
+        }
+        if (m_size == Size) {
+            // No room for the rest of the frame
+            ++m_statistics.overruns;
+            m_discarding = true;
+            m_size = 0;
+            m_scanned = 0;
+        }
+        return false;
+    }
+
+    const statistics& stats() const
+    {
+        return m_statistics;
+    }
+
+  private:
+    bool check(std::span<std::byte> frame, std::span<const std::byte>& payload)
+    {
+        std::size_t size = 0;
+        if (frame.empty()) {
+            // Back-to-back delimiters (e.g. used to flush the line)
+            return false;
+        }
+        if (!cobs::decode_in_place(frame, size) || size < Crc::size) {
+            ++m_statistics.malformed;
+            return false;
+        }
+        const std::size_t data_size = size - Crc::size;
+        const auto data = frame.first(data_size);
+        typename Crc::value_type expected = 0;
+        for (std::size_t i = Crc::size; i > 0; --i) {
+            expected = static_cast<typename Crc::value_type>(
+              (expected << 8) |
+              std::to_integer<uint8_t>(frame[data_size + i - 1]));
+        }
+        if (Crc::compute(data) != expected) {
+            ++m_statistics.crc_errors;
+            return false;
+        }
+        payload = data;
+        return true;
+    }
+
+    // Drops the bytes of the frames already returned
+    void compact()
+    {
+        if (m_consumed == 0) {
+            return;
+        }
+        std::copy(m_buffer.begin() + static_cast<std::ptrdiff_t>(m_consumed),
+                  m_buffer.begin() + static_cast<std::ptrdiff_t>(m_size),
+                  m_buffer.begin());
+        m_size -= m_consumed;
+        m_scanned -= m_consumed;
+        m_consumed = 0;
+    }
+
+    std::array<std::byte, Size> m_buffer;
+    std::size_t m_size = 0;
+    std::size_t m_scanned = 0;
+    std::size_t m_consumed = 0;
+    bool m_discarding = false;
+    statistics m_statistics;
+};
+
+}
+
+#endif
@@ -23,7 +23,12 @@
 #define GPIO_HPP
 
 #include "rp2040.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
 #include <type_traits>
+#include <utility>
 
 namespace gpio {
 enum class functions : uint8_t
@@ -46,24 +51,47 @@ static constexpr void function_select(functions func)
     ctrl_reg::set_value(std::to_underlying(func));
 }
 
+// The SIO SET/CLR/XOR registers perform the operation on write - a single
+// store, no read-modify-write
 static constexpr void set_as_output(const valid_bit_position auto&... pin_no)
 {
-    platform::registers::gpio_oe_set::set_bits(pin_no...);
+    platform::registers::gpio_oe_set::set_value(
+      static_cast<platform::reg_val_t>(bitmask(pin_no...)));
+}
+
+static constexpr void set_as_input(const valid_bit_position auto&... pin_no)
+{
+    platform::registers::gpio_oe_clr::set_value(
+      static_cast<platform::reg_val_t>(bitmask(pin_no...)));
+}
+
+// State of all pins, sampled with a single load
+static constexpr platform::reg_val_t read_inputs()
+{
+    return platform::registers::gpio_in::value();
+}
+
+static constexpr bool is_high(const valid_bit_position auto& pin_no)
+{
+    return read_bits(read_inputs(), pin_no) != 0;
 }
 
 static constexpr void set_high(const valid_bit_position auto&... pin_no)
 {
-    platform::registers::gpio_out_set::set_bits(pin_no...);
+    platform::registers::gpio_out_set::set_value(
+      static_cast<platform::reg_val_t>(bitmask(pin_no...)));
 }
 
 static constexpr void set_low(const valid_bit_position auto&... pin_no)
 {
-    platform::registers::gpio_out_clr::set_bits(pin_no...);
+    platform::registers::gpio_out_clr::set_value(
+      static_cast<platform::reg_val_t>(bitmask(pin_no...)));
 }
 
 static constexpr void toggle(const valid_bit_position auto&... pin_no)
 {
-    platform::registers::gpio_out_xor::set_bits(pin_no...);
+    platform::registers::gpio_out_xor::set_value(
+      static_cast<platform::reg_val_t>(bitmask(pin_no...)));
 }
 
 template<platform::pins Pin>
@@ -82,6 +110,16 @@ class pin
         gpio::set_as_output(pin_no);
     }
 
+    static constexpr void set_as_input()
+    {
+        gpio::set_as_input(pin_no);
+    }
+
+    static constexpr bool is_high()
+    {
+        return gpio::is_high(pin_no);
+    }
+
     static constexpr void set_high()
     {
         gpio::set_high(pin_no);
@@ -107,6 +145,11 @@ constexpr void set_as_output(const gpio_pin auto&... gpio_pins)
     set_as_output(gpio_pins.pin_no...);
 }
 
+constexpr void set_as_input(const gpio_pin auto&... gpio_pins)
+{
+    set_as_input(gpio_pins.pin_no...);
+}
+
 constexpr void set_high(const gpio_pin auto&... gpio_pins)
 {
     set_high(gpio_pins.pin_no...);
@@ -128,6 +171,162 @@ constexpr void function_select(functions func,
     ((function_select<gpio_pins.pin_no>(func)), ...);
 }
 
+// A group of pins driven as a single N-bit value: bit 0 of the value goes
+// to the first pin, bit 1 to the second one and so on.
+//
+// The spread of the value into the pin positions is resolved at compile
+// time: a shift for contiguous pins, a lookup table for up to 4 pins or a
+// sequence of shifts otherwise (constant time in all cases). write() reads
+// GPIO_OUT once (a single-cycle SIO access) and updates all pins with one
+// store to GPIO_OUT_XOR - they change at the same time and the other pins
+// are not touched.
+template<platform::pins... Pins>
+class bus
+{
+  public:
+    static constexpr std::size_t width = sizeof...(Pins);
+    static constexpr platform::reg_val_t mask =
+      static_cast<platform::reg_val_t>(bitmask(Pins...));
+
+    static_assert(width > 0, "Empty bus");
+    static_assert(std::popcount(mask) == width, "Duplicated pins");
+
+    static constexpr void function_select(functions func)
+    {
+        ((gpio::function_select<Pins>(func)), ...);
+    }
+
+    static constexpr void set_as_output()
+    {
+        gpio::set_as_output(Pins...);
+    }
+
+    static constexpr platform::reg_val_t spread(platform::reg_val_t value)
+    {
+        if constexpr (is_contiguous) {
+            return (value << first_pin) & mask;
+        } else if constexpr (width <= lookup_table_max_width) {
+            return lookup_table[value & value_mask];
+        } else {
+            return spread_with_shifts(value);
+        }
+    }
+
+    static constexpr void write(platform::reg_val_t value)
+    {
+        const auto current = platform::registers::gpio_out::value();
+        platform::registers::gpio_out_xor::set_value((current ^ spread(value)) &
+                                                     mask);
+    }
+
+  private:
+    static constexpr std::size_t lookup_table_max_width = 4;
+    static constexpr platform::reg_val_t value_mask =
+      static_cast<platform::reg_val_t>((1ULL << width) - 1);
+    static constexpr platform::reg_val_t first_pin =
+      std::to_underlying(std::min({Pins...}));
+    static constexpr bool is_contiguous = [] {
+        platform::reg_val_t expected_pin = first_pin;
+        return ((std::to_underlying(Pins) == expected_pin++) && ...);
+    }();
+
+    static constexpr platform::reg_val_t spread_with_shifts(
+      platform::reg_val_t value)
+    {
+        return [value]<std::size_t... Index>(std::index_sequence<Index...>) {
+            return (
+              (((value >> Index) & 1U) << std::to_underlying(Pins)) | ...);
+        }(std::make_index_sequence<width>{});
+    }
+
+    static constexpr auto lookup_table = [] {
+        std::array<platform::reg_val_t,
+                   (width <= lookup_table_max_width) ? (1U << width) : 0>
+          table{};
+        for (platform::reg_val_t value = 0; value < table.size(); ++value) {
+            table[value] = spread_with_shifts(value);
+        }
+        return table;
+    }();
+};
+
+// Debounces all inputs at once using vertical counters: a 2-bit counter per
+// pin kept in two words (bit N of both words belongs to the pin N). The
+// debounced state of a pin changes after 4 consecutive samples differing
+// from it, all pins are processed with a handful of bitwise operations on
+// whole words - no loop over the pins.
+//
+// Call scan() periodically (e.g. every 5ms from a timer alarm). The edge
+// masks are valid until the next scan.
+class input_scanner
+{
+  public:
+    using mask_t = platform::reg_val_t;
+
+    constexpr explicit input_scanner(mask_t initial_state = 0)
+      : m_state(initial_state)
+    {
+    }
+
+    void scan()
+    {
+        update(read_inputs());
+    }
+
+    constexpr void update(mask_t sample)
+    {
+        const mask_t changed = sample ^ m_state;
+
+        // Count the samples differing from the debounced state, the counters
+        // of the stable pins are cleared
+        m_count1 = (m_count1 ^ m_count0) & changed;
+        m_count0 = ~m_count0 & changed;
+
+        // The counter wrapped around - accept the new state
+        const mask_t toggled = changed & ~(m_count0 | m_count1);
+        m_state ^= toggled;
+        m_rising = toggled & m_state;
+        m_falling = toggled & ~m_state;
+    }
+
+    constexpr mask_t state() const
+    {
+        return m_state;
+    }
+
+    constexpr mask_t rising() const
+    {
+        return m_rising;
+    }
+
+    constexpr mask_t falling() const
+    {
+        return m_falling;
+    }
+
+    constexpr bool is_high(const valid_bit_position auto& pin_no) const
+    {
+        return read_bits(m_state, pin_no) != 0;
+    }
+
+    constexpr bool rose(const valid_bit_position auto& pin_no) const
+    {
+        return read_bits(m_rising, pin_no) != 0;
+    }
+
+    constexpr bool fell(const valid_bit_position auto& pin_no) const
+    {
+        return read_bits(m_falling, pin_no) != 0;
+    }
+
+  private:
+    mask_t m_state;
+    mask_t m_count0 = 0;
+    mask_t m_count1 = 0;
+    mask_t m_rising = 0;
+    mask_t m_falling = 0;
+};
+
 }
 
 #endif
@@ -0,0 +1,222 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef GPIO_INTERRUPTS_HPP
+#define GPIO_INTERRUPTS_HPP
+
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <utility>
+
+#include "gpio.hpp"
+#include "irq.hpp"
+#include "rp2040.hpp"
+
+namespace gpio {
+
+// Bit positions of the events within the 4-bit group of a pin
+enum class irq_events : platform::reg_val_t
+{
+    level_low = 0,
+    level_high,
+    edge_low,
+    edge_high,
+};
+
+namespace detail {
+template<platform::pins Pin>
+using interrupt_for = platform::registers::gpio_interrupt_for<Pin>;
+
+template<platform::pins Pin>
+constexpr platform::reg_val_t interrupt_mask(
+  const std::same_as<irq_events> auto... events)
+{
+    return static_cast<platform::reg_val_t>(bitmask(events...))
+           << interrupt_for<Pin>::shift;
+}
+
+// Edge events are latched in INTR and have to be acknowledged, level events
+// follow the input
+constexpr platform::reg_val_t edge_events_mask = 0xcccccccc;
+}
+
+template<platform::pins Pin>
+constexpr static void enable_interrupt(
+  const std::same_as<irq_events> auto... events)
+{
+    using inte =
+      platform::registers::gpio_proc0_inte<detail::interrupt_for<Pin>::index>;
+    inte::atomic_set_bits(detail::interrupt_for<Pin>::shift +
+                          std::to_underlying(events)...);
+}
+
+template<platform::pins Pin>
+constexpr static void disable_interrupt(
+  const std::same_as<irq_events> auto... events)
+{
+    using inte =
+      platform::registers::gpio_proc0_inte<detail::interrupt_for<Pin>::index>;
+    inte::atomic_clear_bits(detail::interrupt_for<Pin>::shift +
+                            std::to_underlying(events)...);
+}
+
+// INTR is write 1 to clear - a single store, no read-modify-write
+template<platform::pins Pin>
+constexpr static void acknowledge_interrupt(
+  const std::same_as<irq_events> auto... events)
+{
+    using intr =
+      platform::registers::gpio_intr<detail::interrupt_for<Pin>::index>;
+    intr::set_value(detail::interrupt_mask<Pin>(events...));
+}
+
+// Binds the events of a pin to a handler called as `Handler(events)`, where
+// `events` holds the pending events of the pin (bit N - irq_events N)
+template<gpio_pin Pin, auto Handler, irq_events... Events>
+    requires std::invocable<decltype(Handler), platform::reg_val_t>
+struct interrupt_handler
+{
+    static_assert(sizeof...(Events) > 0, "No events selected");
+
+    static constexpr platform::pins pin_no = Pin::pin_no;
+    static constexpr platform::reg_val_t index =
+      detail::interrupt_for<pin_no>::index;
+    static constexpr platform::reg_val_t shift =
+      detail::interrupt_for<pin_no>::shift;
+    static constexpr platform::reg_val_t mask =
+      detail::interrupt_mask<pin_no>(Events...);
+
+    static void call(platform::reg_val_t events)
+    {
+        Handler(events);
+    }
+};
+
+template<typename T>
+concept gpio_interrupt_handler = requires {
+    { T::pin_no } -> std::convertible_to<platform::pins>;
+    { T::index } -> std::convertible_to<platform::reg_val_t>;
+    { T::mask } -> std::convertible_to<platform::reg_val_t>;
+    T::call(platform::reg_val_t{});
+};
+
+// Dispatches the IO_BANK0 interrupt to per-pin handlers, the handler table is
+// resolved at compile time:
+//
+//   - only the INTS registers of the handled pins are read (one load each),
+//   - pending edges are acknowledged with a single store per register,
+//   - every handler is a test of its bits followed by a direct call.
+//
+// The set INTS bits are not walked with count-leading-zeros: the Cortex-M0+
+// has no CLZ instruction (std::countl_zero is a libgcc call) and the handlers
+// are known at compile time - the unrolled tests of the handled pins cost
+// less than a loop over the pending bits for the usual handful of handlers.
+//
+// Install with:
+//
+//     using gpio_irqs = gpio::interrupt_dispatcher<...>;
+//     extern "C" void io_irq_bank0_isr() { gpio_irqs::dispatch(); }
+template<gpio_interrupt_handler... Handlers>
+class interrupt_dispatcher
+{
+  public:
+    static constexpr std::size_t registers_count = 4;
+
+    static_assert(sizeof...(Handlers) > 0, "No handlers");
+    static_assert(std::popcount(static_cast<platform::reg_val_t>(
+                    bitmask(Handlers::pin_no...))) == sizeof...(Handlers),
+                  "Multiple handlers for a single pin");
+
+    static void enable()
+    {
+        for_each_register([]<std::size_t Index>() {
+            if constexpr (handled_mask<Index> != 0) {
+                using intr = platform::registers::gpio_intr<Index>;
+                using inte = platform::registers::gpio_proc0_inte<Index>;
+                intr::set_value(handled_mask<Index>);
+                inte::atomic_set_mask(handled_mask<Index>);
+            }
+        });
+        irq::enable(platform::irqs::io_irq_bank0);
+    }
+
+    static void disable()
+    {
+        irq::disable(platform::irqs::io_irq_bank0);
+        for_each_register([]<std::size_t Index>() {
+            if constexpr (handled_mask<Index> != 0) {
+                using inte = platform::registers::gpio_proc0_inte<Index>;
+                inte::atomic_clear_mask(handled_mask<Index>);
+            }
+        });
+    }
+
+    static void dispatch()
+    {
+        for_each_register([]<std::size_t Index>() {
+            if constexpr (handled_mask<Index> != 0) {
+                dispatch_register<Index>();
+            }
+        });
+    }
+
+  private:
+    template<std::size_t Index>
+    static constexpr platform::reg_val_t handled_mask =
+      ((Handlers::index == Index ? Handlers::mask : 0) | ...);
+
+    static void for_each_register(auto&& body)
+    {
+        [&]<std::size_t... Index>(std::index_sequence<Index...>) {
+            (body.template operator()<Index>(), ...);
+        }(std::make_index_sequence<registers_count>{});
+    }
+
+    template<std::size_t Index>
+    static void dispatch_register()
+    {
+        using ints = platform::registers::gpio_proc0_ints<Index>;
+        using intr = platform::registers::gpio_intr<Index>;
+
+        const platform::reg_val_t status =
+          ints::value() & handled_mask<Index>;
+        if constexpr ((handled_mask<Index> & detail::edge_events_mask) != 0) {
+            intr::set_value(status & detail::edge_events_mask);
+        }
+        (dispatch_handler<Index, Handlers>(status), ...);
+    }
+
+    template<std::size_t Index, typename Handler>
+    static void dispatch_handler(platform::reg_val_t status)
+    {
+        if constexpr (Handler::index == Index) {
+            if ((status & Handler::mask) != 0) {
+                Handler::call((status & Handler::mask) >> Handler::shift);
+            }
+        }
+    }
+};
+
+}
+
+#endif
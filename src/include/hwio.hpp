@@ -21,8 +21,10 @@
 #ifndef HWIO_HPP
 #define HWIO_HPP
 
+#include <array>
 #include <concepts>
 #include <cstdint>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 
@@ -74,11 +76,41 @@ constexpr auto region_value(const region_strong auto& region)
     return std::to_underlying(region.value);
 }
 
+// Register access backend: plain memory-mapped I/O (the default one).
+//
+// A backend is a type providing static read/write functions used by
+// hwio::reg for every access to the register. Alternative backends (e.g.
+// hwio::simulated, see hwio_simulator.hpp) allow the drivers to run on a
+// host machine.
+struct mmio
+{
+    template<typename RegPtrType>
+    constexpr static std::remove_cv_t<RegPtrType> read(auto addr)
+    {
+        return *reinterpret_cast<RegPtrType*>(addr);
+    }
+
+    template<typename RegPtrType>
+    constexpr static void write(auto addr, std::remove_cv_t<RegPtrType> value)
+    {
+        *reinterpret_cast<RegPtrType*>(addr) = value;
+    }
+};
+
+// clang-format off
+template<typename T>
+concept hwio_backend = requires(std::uint32_t addr, std::uint32_t value) {
+    { T::template read<volatile std::uint32_t>(addr) };
+    { T::template write<volatile std::uint32_t>(addr, value) };
+};
+// clang-format on
+
 template<typename RegPtrType,
          typename RegValueType,
          RegPtrType BaseAddr,
          RegPtrType Offset = 0,
          typename BitsType = unsigned int,
+         hwio_backend Backend = mmio,
          hwio_region... Region>
 class reg
 {
@@ -87,32 +119,54 @@ class reg
     using reg_addr_t = std::decay_t<std::remove_pointer_t<RegPtrType>>;
     using reg_ptr_t = RegPtrType*;
     using bits_t = BitsType;
+    using backend = Backend;
 
     constexpr static reg_addr_t base = BaseAddr;
     constexpr static reg_addr_t offset = Offset;
     constexpr static reg_addr_t addr = (base + offset);
 
     constexpr static reg_ptr_t ptr()
+        requires std::same_as<Backend, mmio>
     {
         return reinterpret_cast<reg_ptr_t>(addr);
     }
 
     constexpr static auto& ref()
+        requires std::same_as<Backend, mmio>
     {
         return *ptr();
     }
 
     constexpr static const auto& cref()
+        requires std::same_as<Backend, mmio>
     {
         return *ptr();
     }
 
+    constexpr static reg_value_t read()
+    {
+        return Backend::template read<RegPtrType>(addr);
+    }
+
+    constexpr static void write(reg_value_t value)
+    {
+        Backend::template write<RegPtrType>(addr, value);
+    }
+
+    // Write to a write-only alias of this register placed at
+    // (addr + AliasOffset) - see hwio::atomic_aliases
+    template<reg_addr_t AliasOffset>
+    constexpr static void write_alias(reg_value_t value)
+    {
+        Backend::template write<RegPtrType>(addr + AliasOffset, value);
+    }
+
     template<typename R>
         requires is_one_of_valid_regions<R, Region...>
     constexpr static reg_value_t region_mask(const R& region)
     {
         auto reg_bits = sizeof(reg_value_t) * 8;
-        reg_value_t all_bits = ~0UL;
+        auto all_bits = static_cast<reg_value_t>(~0UL);
         return (all_bits >> (reg_bits - region.length)) << region.first_bit;
     }
 
@@ -125,6 +179,22 @@ class reg
           region_mask(region));
     }
 
+    // Extract the region from the value of the register (scoped enum regions
+    // are converted to their enum types)
+    template<typename R>
+        requires is_one_of_valid_regions<R, Region...>
+    constexpr static typename R::value_t region_from_value(reg_value_t value)
+    {
+        const auto bits = (value & region_mask(R{})) >> R::first_bit;
+        if constexpr (std::is_scoped_enum_v<typename R::value_t>) {
+            using underlying_t = std::underlying_type_t<typename R::value_t>;
+            return static_cast<typename R::value_t>(
+              static_cast<underlying_t>(bits));
+        } else {
+            return static_cast<typename R::value_t>(bits);
+        }
+    }
+
     constexpr static auto all_regions_mask()
     {
         return bitwise_or(region_mask(Region{})...);
@@ -136,12 +206,14 @@ template<typename RegPtrType,
          RegPtrType BaseAddr,
          RegPtrType Offset = 0,
          typename BitsType = unsigned int,
+         hwio_backend Backend = mmio,
          hwio_region... Region>
 using volatile_reg = reg<volatile RegPtrType,
                          RegValueType,
                          BaseAddr,
                          Offset,
                          BitsType,
+                         Backend,
                          Region...>;
 
 // clang-format off
@@ -158,49 +230,108 @@ concept hwio_reg = requires {
 };
 // clang-format on
 
+// Describes a register block which provides write-only aliases performing
+// atomic XOR/SET/CLR operations on every register within the block (the
+// alias is placed at the register address + the given offset).
+template<typename RegAddrType,
+         RegAddrType XorOffset,
+         RegAddrType SetOffset,
+         RegAddrType ClrOffset>
+struct atomic_aliases
+{
+    constexpr static RegAddrType xor_offset = XorOffset;
+    constexpr static RegAddrType set_offset = SetOffset;
+    constexpr static RegAddrType clr_offset = ClrOffset;
+};
+
+// Register block without atomic aliases (plain read-modify-write only)
+struct no_atomic_aliases
+{};
+
+// clang-format off
+template<typename T>
+concept hwio_atomic_aliases = requires {
+    { T::xor_offset };
+    { T::set_offset };
+    { T::clr_offset };
+};
+// clang-format on
+
 template<typename T>
 class ro : public T
 {
   public:
     constexpr static typename T::reg_value_t value()
     {
-        return T::cref();
+        return T::read();
     }
 
     constexpr static typename T::reg_value_t get_bit(typename T::bits_t bit_no)
     {
-        return bitwise_and(T::cref(), bit_value(bit_no));
+        return static_cast<typename T::reg_value_t>(
+          bitwise_and(T::read(), bit_value(bit_no)));
     }
 
     constexpr static typename T::reg_value_t get_bits_with_mask(
       typename T::reg_value_t mask)
     {
-        return bitwise_and(T::cref(), mask);
+        return bitwise_and(T::read(), mask);
+    }
+
+    // The following operations perform a single read of the register and
+    // decode all requested fields from the value, e.g.:
+    //
+    //   const auto [wlen, parity] =
+    //     uartlcr_h::read_regions<uartlcr_h_region_wlen,
+    //                             uartlcr_h_region_parity>();
+    //
+    //   const auto [busy, rxfe] = uartfr::read_bits(uartfr_bits::busy,
+    //                                               uartfr_bits::rxfe);
+
+    template<hwio_region... R>
+    constexpr static std::tuple<typename R::value_t...> read_regions()
+    {
+        const auto value = T::read();
+        return {T::template region_from_value<R>(value)...};
+    }
+
+    constexpr static auto read_bits(
+      const std::convertible_to<typename T::bits_t> auto... bit_no)
+    {
+        using bits_t = typename T::bits_t;
+        const auto value = T::read();
+        return std::array<bool, sizeof...(bit_no)>{
+          ((value & bit_value(static_cast<bits_t>(bit_no))) != 0)...};
     }
 };
 
-template<typename T>
+template<typename T, typename Aliases = no_atomic_aliases>
 class wo : public T
 {
   public:
+    using aliases = Aliases;
+
     constexpr static void set_bits(const valid_bit_position auto&... bit_no)
     {
-        ::set_bits(T::ref(), bit_no...);
+        T::write(
+          static_cast<typename T::reg_value_t>(T::read() | bitmask(bit_no...)));
     }
 
     constexpr static void reset_bits(const valid_bit_position auto&... bit_no)
     {
-        ::reset_bits(T::ref(), bit_no...);
+        T::write(
+          static_cast<typename T::reg_value_t>(T::read() & ~bitmask(bit_no...)));
     }
 
     constexpr static void toggle(const valid_bit_position auto&... bit_no)
     {
-        ::toggle_bits(T::ref(), bit_no...);
+        T::write(
+          static_cast<typename T::reg_value_t>(T::read() ^ bitmask(bit_no...)));
     }
 
     constexpr static void set_value(typename T::reg_value_t value)
     {
-        T::ref() = value;
+        T::write(value);
     }
 
     constexpr auto& operator=(typename T::reg_value_t value) const
@@ -216,22 +347,263 @@ class wo : public T
     }
 
     // This operation performs a single read and a single write from/to the
-    // register
+    // register (a single write if the regions cover the whole register)
     constexpr static void update_regions(const auto... region)
     {
-        T::ref() = (T::cref() & ~bitwise_or(T::region_mask(region)...)) |
-                   regions_to_register_value(region...);
+        constexpr auto mask =
+          bitwise_or(T::region_mask(decltype(region){})...);
+        if constexpr (mask == static_cast<typename T::reg_value_t>(~0UL)) {
+            T::write(regions_to_register_value(region...));
+        } else {
+            T::write((T::read() & ~mask) |
+                     regions_to_register_value(region...));
+        }
     }
 
     constexpr static void clear_regions(const auto... region)
     {
-        T::ref() = (T::cref() & ~bitwise_or(T::region_mask(region)...));
+        T::write(T::read() & ~bitwise_or(T::region_mask(region)...));
+    }
+
+    // The following operations use the atomic aliases of the register, they
+    // perform writes only (no read from the register at all) and are safe
+    // against concurrent modifications of other bits (ISR, the other core)
+
+    template<hwio_atomic_aliases A = Aliases>
+    constexpr static void atomic_set_bits(
+      const valid_bit_position auto&... bit_no)
+    {
+        T::template write_alias<A::set_offset>(
+          static_cast<typename T::reg_value_t>(bitmask(bit_no...)));
+    }
+
+    template<hwio_atomic_aliases A = Aliases>
+    constexpr static void atomic_clear_bits(
+      const valid_bit_position auto&... bit_no)
+    {
+        T::template write_alias<A::clr_offset>(
+          static_cast<typename T::reg_value_t>(bitmask(bit_no...)));
+    }
+
+    template<hwio_atomic_aliases A = Aliases>
+    constexpr static void atomic_toggle(const valid_bit_position auto&... bit_no)
+    {
+        T::template write_alias<A::xor_offset>(
+          static_cast<typename T::reg_value_t>(bitmask(bit_no...)));
+    }
+
+    template<hwio_atomic_aliases A = Aliases>
+    constexpr static void atomic_set_mask(typename T::reg_value_t mask)
+    {
+        T::template write_alias<A::set_offset>(mask);
+    }
+
+    template<hwio_atomic_aliases A = Aliases>
+    constexpr static void atomic_clear_mask(typename T::reg_value_t mask)
+    {
+        T::template write_alias<A::clr_offset>(mask);
+    }
+
+    // This operation performs two writes (CLR + SET) and no reads. Note that
+    // the register passes through an intermediate state (all regions
+    // cleared) between the writes.
+    template<hwio_atomic_aliases A = Aliases>
+    constexpr static void atomic_update_regions(const auto... region)
+    {
+        T::template write_alias<A::clr_offset>(
+          bitwise_or(T::region_mask(region)...));
+        T::template write_alias<A::set_offset>(
+          regions_to_register_value(region...));
     }
 };
 
-template<typename T>
-class rw : public ro<T>, public wo<T>
+template<typename T, typename Aliases = no_atomic_aliases>
+class rw : public ro<T>, public wo<T, Aliases>
+{};
+
+// A single, deferred modification of a register: bits selected by the mask
+// are replaced with the corresponding bits of the value.
+template<typename Reg>
+struct edit
+{
+    using reg = Reg;
+    typename Reg::reg_value_t mask;
+    typename Reg::reg_value_t value;
+};
+
+// Marks an ordering point within a transaction. Edits placed on different
+// sides of the marker are never merged and are committed in order.
+struct ordered_t
 {};
 
+constexpr ordered_t ordered [[maybe_unused]]{};
+
+// Builders of edits (counterparts of the hwio::wo operations)
+namespace op {
+
+template<typename Reg>
+constexpr edit<Reg> update_regions(const auto... region)
+{
+    return {.mask = bitwise_or(Reg::region_mask(region)...),
+            .value = Reg::regions_to_register_value(region...)};
+}
+
+template<typename Reg>
+constexpr edit<Reg> clear_regions(const auto... region)
+{
+    return {.mask = bitwise_or(Reg::region_mask(region)...), .value = 0};
+}
+
+template<typename Reg>
+constexpr edit<Reg> set_bits(const valid_bit_position auto&... bit_no)
+{
+    const auto mask =
+      static_cast<typename Reg::reg_value_t>(bitmask(bit_no...));
+    return {.mask = mask, .value = mask};
+}
+
+template<typename Reg>
+constexpr edit<Reg> reset_bits(const valid_bit_position auto&... bit_no)
+{
+    return {.mask = static_cast<typename Reg::reg_value_t>(bitmask(bit_no...)),
+            .value = 0};
+}
+
+template<typename Reg>
+constexpr edit<Reg> set_value(typename Reg::reg_value_t value)
+{
+    return {.mask = static_cast<typename Reg::reg_value_t>(~0UL),
+            .value = value};
+}
+
+}
+
+template<typename T>
+concept transaction_element =
+  std::same_as<T, ordered_t> || requires(T t) {
+      typename T::reg;
+      t.mask;
+      t.value;
+  };
+
+// Gathers edits of (possibly many) registers and commits them with exactly
+// one read and one write per register touched (only a write when the whole
+// register is overwritten). Edits of the same register are merged in the
+// order of appearance; registers are written in order of their first edit
+// and hwio::ordered splits the transaction into sequential groups.
+//
+// Example:
+//   hwio::transaction{
+//     hwio::op::update_regions<uartlcr_h>(wlen{...}, parity{...}),
+//     hwio::op::set_bits<uartlcr_h>(uartlcr_h_bits::fen),
+//     hwio::ordered,
+//     hwio::op::set_bits<uartcr>(uartcr_bits::uarten)}.commit();
+template<transaction_element... Op>
+class transaction
+{
+  public:
+    constexpr explicit transaction(Op... op)
+      : m_ops{op...}
+    {
+    }
+
+    constexpr void commit() const
+    {
+        commit(std::index_sequence_for<Op...>{});
+    }
+
+  private:
+    static constexpr std::size_t size = sizeof...(Op);
+    static constexpr std::array<bool, size> is_ordering_point{
+      std::same_as<Op, ordered_t>...};
+
+    template<typename T>
+    consteval static std::uintmax_t address_of()
+    {
+        if constexpr (std::same_as<T, ordered_t>) {
+            return 0;
+        } else {
+            return T::reg::addr;
+        }
+    }
+
+    static constexpr std::array<std::uintmax_t, size> address{
+      address_of<Op>()...};
+
+    consteval static std::array<std::size_t, size> calculate_groups()
+    {
+        std::array<std::size_t, size> group{};
+        std::size_t current = 0;
+        for (std::size_t i = 0; i < size; ++i) {
+            if (is_ordering_point[i]) {
+                ++current;
+            }
+            group[i] = current;
+        }
+        return group;
+    }
+
+    static constexpr std::array<std::size_t, size> group = calculate_groups();
+
+    consteval static bool same_register(std::size_t lhs, std::size_t rhs)
+    {
+        return !is_ordering_point[lhs] && !is_ordering_point[rhs] &&
+               group[lhs] == group[rhs] && address[lhs] == address[rhs];
+    }
+
+    consteval static bool is_first_edit(std::size_t index)
+    {
+        if (is_ordering_point[index]) {
+            return false;
+        }
+        for (std::size_t i = 0; i < index; ++i) {
+            if (same_register(i, index)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template<std::size_t... Index>
+    constexpr void commit(std::index_sequence<Index...>) const
+    {
+        (commit_register<Index>(), ...);
+    }
+
+    template<std::size_t First>
+    constexpr void commit_register() const
+    {
+        if constexpr (is_first_edit(First)) {
+            using reg = std::tuple_element_t<First, std::tuple<Op...>>::reg;
+            using value_t = typename reg::reg_value_t;
+            constexpr auto all_bits = static_cast<value_t>(~0UL);
+
+            value_t mask = 0;
+            value_t value = 0;
+            [&]<std::size_t... Index>(std::index_sequence<Index...>) {
+                (merge_edit<Index, First>(mask, value), ...);
+            }(std::index_sequence_for<Op...>{});
+
+            if (mask == all_bits) {
+                reg::set_value(value);
+            } else {
+                reg::set_value((reg::value() & ~mask) | value);
+            }
+        }
+    }
+
+    template<std::size_t Index, std::size_t First>
+    constexpr void merge_edit(auto& mask, auto& value) const
+    {
+        if constexpr (same_register(Index, First)) {
+            const auto& edit = std::get<Index>(m_ops);
+            value = (value & ~edit.mask) | (edit.value & edit.mask);
+            mask = mask | edit.mask;
+        }
+    }
+
+    std::tuple<Op...> m_ops;
+};
+
 }
 #endif
@@ -0,0 +1,310 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef HWIO_INSTRUMENTATION_HPP
+#define HWIO_INSTRUMENTATION_HPP
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "hwio.hpp"
+
+// Register access instrumentation - counts reads and writes of every
+// register and keeps a trace of the most recent accesses.
+//
+// The instrumentation is enabled by selecting hwio::instrumented as the
+// register access backend (see boards/raspberry_pico.hpp). All other
+// backends are not affected in any way (zero overhead when disabled).
+//
+// The recorder is not interrupt safe: an access performed by an ISR while
+// the main thread is inside of record() may be lost or mixed up with the
+// interrupted one. Good enough for tuning, do not use it for accounting.
+namespace hwio::instrumentation {
+
+enum class access : std::uint8_t
+{
+    read,
+    write,
+};
+
+struct trace_entry
+{
+    std::uint32_t timestamp;
+    std::uint32_t addr;
+    std::uint32_t value;
+    access kind;
+};
+
+struct register_counters
+{
+    std::uint32_t addr;
+    std::uint32_t reads;
+    std::uint32_t writes;
+};
+
+// Statically allocated storage for the statistics (.bss only, no heap):
+//
+//  * CounterSlots - capacity of the open addressing table of per-register
+//    counters, accesses to registers which do not fit are counted as
+//    untracked,
+//  * TraceEntries - capacity of the trace ring (the oldest entries are
+//    overwritten).
+//
+// Both must be powers of two (Cortex-M0+ has no divide instruction).
+template<std::size_t CounterSlots, std::size_t TraceEntries>
+class recorder
+{
+    static_assert(std::has_single_bit(CounterSlots),
+                  "CounterSlots must be a power of two");
+    static_assert(std::has_single_bit(TraceEntries),
+                  "TraceEntries must be a power of two");
+
+  public:
+    using counters_t = std::array<register_counters, CounterSlots>;
+
+    static void record(access kind,
+                       std::uint32_t addr,
+                       std::uint32_t value,
+                       std::uint32_t timestamp)
+    {
+        if (m_paused) {
+            return;
+        }
+        count(kind, addr);
+        m_trace[m_trace_head & trace_mask] = {.timestamp = timestamp,
+                                              .addr = addr,
+                                              .value = value,
+                                              .kind = kind};
+        ++m_trace_head;
+    }
+
+    // Unused slots have the address of 0
+    static const counters_t& counters()
+    {
+        return m_counters;
+    }
+
+    static std::uint32_t untracked_accesses()
+    {
+        return m_untracked;
+    }
+
+    static std::size_t trace_size()
+    {
+        return m_trace_head < TraceEntries ? m_trace_head : TraceEntries;
+    }
+
+    // @param index 0 is the oldest entry
+    static const trace_entry& trace_at(std::size_t index)
+    {
+        return m_trace[(m_trace_head - trace_size() + index) & trace_mask];
+    }
+
+    // Number of entries overwritten by the newer ones
+    static std::uint32_t trace_dropped()
+    {
+        return m_trace_head - static_cast<std::uint32_t>(trace_size());
+    }
+
+    // Stop recording (e.g. while dumping the statistics through a
+    // peripheral which is instrumented as well)
+    static void pause()
+    {
+        m_paused = true;
+    }
+
+    static void resume()
+    {
+        m_paused = false;
+    }
+
+    static void clear()
+    {
+        m_counters = {};
+        m_untracked = 0;
+        m_trace_head = 0;
+    }
+
+  private:
+    static constexpr std::size_t counters_mask = CounterSlots - 1;
+    static constexpr std::size_t trace_mask = TraceEntries - 1;
+
+    static void count(access kind, std::uint32_t addr)
+    {
+        std::size_t slot = 0;
+        if constexpr (CounterSlots > 1) {
+            // Fibonacci hashing - peripherals share the register offsets
+            constexpr std::uint32_t golden_ratio = 0x9e3779b1;
+            constexpr int shift = 32 - std::bit_width(counters_mask);
+            slot = (addr * golden_ratio) >> shift;
+        }
+
+        for (std::size_t probe = 0; probe < CounterSlots; ++probe) {
+            auto& entry = m_counters[(slot + probe) & counters_mask];
+            if (entry.addr == 0) {
+                entry.addr = addr;
+            }
+            if (entry.addr == addr) {
+                ++(kind == access::read ? entry.reads : entry.writes);
+                return;
+            }
+        }
+        ++m_untracked;
+    }
+
+    static inline counters_t m_counters{};
+    static inline std::array<trace_entry, TraceEntries> m_trace{};
+    static inline std::uint32_t m_trace_head = 0;
+    static inline std::uint32_t m_untracked = 0;
+    static inline bool m_paused = false;
+};
+
+// Timestamps taken from a free running counter register (read directly
+// through the given backend - the read itself is not recorded)
+template<hwio_backend Backend, std::uint32_t Addr>
+struct register_clock
+{
+    static std::uint32_t now()
+    {
+        return static_cast<std::uint32_t>(
+          Backend::template read<volatile std::uint32_t>(Addr));
+    }
+};
+
+// Timestamps replaced with a sequence number of the access
+struct sequence_clock
+{
+    static std::uint32_t now()
+    {
+        return m_sequence++;
+    }
+
+  private:
+    static inline std::uint32_t m_sequence = 0;
+};
+
+namespace detail {
+constexpr char hex_digits[] = "0123456789abcdef";
+
+void put_hex(const auto& output, std::uint32_t value)
+{
+    for (int shift = 28; shift >= 0; shift -= 4) {
+        output.putc(hex_digits[(value >> shift) & 0xf]);
+    }
+}
+
+void put_record(const auto& output, char tag, const auto... field)
+{
+    output.putc(tag);
+    ((output.putc(' '), put_hex(output, field)), ...);
+    output.putc('\n');
+}
+}
+
+// Dump the statistics as text (decoded by tools/hwio_trace.py), `output`
+// must provide putc(char), e.g. uart::uart0_tag. All numbers in hex:
+//
+//   C <addr> <reads> <writes>            - counters (one per register)
+//   U <accesses>                         - untracked accesses
+//   D <entries>                          - entries dropped from the trace
+//   T <timestamp> <addr> <value> <0|1>   - trace (oldest first, 1 = write)
+//   E                                    - end of the dump
+template<typename Recorder>
+void dump(const auto& output)
+{
+    Recorder::pause();
+    for (const auto& counters : Recorder::counters()) {
+        if (counters.addr != 0) {
+            detail::put_record(
+              output, 'C', counters.addr, counters.reads, counters.writes);
+        }
+    }
+    detail::put_record(output, 'U', Recorder::untracked_accesses());
+    detail::put_record(output, 'D', Recorder::trace_dropped());
+    for (std::size_t i = 0; i < Recorder::trace_size(); ++i) {
+        const auto& entry = Recorder::trace_at(i);
+        detail::put_record(output,
+                           'T',
+                           entry.timestamp,
+                           entry.addr,
+                           entry.value,
+                           static_cast<std::uint32_t>(entry.kind));
+    }
+    detail::put_record(output, 'E');
+    Recorder::resume();
+}
+
+}
+
+namespace hwio {
+
+// Register access backend recording every access (see the namespace
+// hwio::instrumentation above) and forwarding it to the Inner backend
+template<hwio_backend Inner, typename Recorder, typename Clock>
+struct instrumented
+{
+    using inner = Inner;
+    using recorder = Recorder;
+
+    template<typename RegPtrType>
+    static std::remove_cv_t<RegPtrType> read(auto addr)
+    {
+        const auto value = Inner::template read<RegPtrType>(addr);
+        Recorder::record(instrumentation::access::read,
+                         static_cast<std::uint32_t>(addr),
+                         static_cast<std::uint32_t>(value),
+                         Clock::now());
+        return value;
+    }
+
+    template<typename RegPtrType>
+    static void write(auto addr, std::remove_cv_t<RegPtrType> value)
+    {
+        Recorder::record(instrumentation::access::write,
+                         static_cast<std::uint32_t>(addr),
+                         static_cast<std::uint32_t>(value),
+                         Clock::now());
+        Inner::template write<RegPtrType>(addr, value);
+    }
+};
+
+// The backend without the instrumentation layer (if any)
+template<hwio_backend Backend>
+struct uninstrumented
+{
+    using type = Backend;
+};
+
+template<hwio_backend Inner, typename Recorder, typename Clock>
+struct uninstrumented<instrumented<Inner, Recorder, Clock>>
+{
+    using type = Inner;
+};
+
+template<hwio_backend Backend>
+using uninstrumented_t = typename uninstrumented<Backend>::type;
+
+}
+
+#endif
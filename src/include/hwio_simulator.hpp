@@ -0,0 +1,266 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef HWIO_SIMULATOR_HPP
+#define HWIO_SIMULATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+#include "hwio.hpp"
+
+// Simulated register file - a host-only register access backend.
+//
+// Every register starts with the value of 0 (unless poked). Hooks can be
+// attached to addresses to model the hardware behaviour (e.g. a status bit
+// which follows a control bit, a counter advancing on every read).
+namespace hwio::simulator {
+
+using address_t = std::uint64_t;
+using value_t = std::uint64_t;
+
+enum class write_operation
+{
+    store,
+    bitwise_xor,
+    bitwise_set,
+    bitwise_clear,
+};
+
+struct decoded_address
+{
+    address_t target;
+    write_operation operation = write_operation::store;
+};
+
+// Translates the address of a write into the target register and the
+// operation to perform (models the atomic aliases of the peripherals)
+using alias_decoder = std::function<decoded_address(address_t)>;
+
+// Returns the value observed by the CPU, `current` is the stored value
+using read_hook = std::function<value_t(address_t addr, value_t current)>;
+
+// Called after the value has been stored to the register
+using write_hook = std::function<void(address_t addr, value_t value)>;
+
+class register_file
+{
+  public:
+    value_t read(address_t addr)
+    {
+        ++m_reads[addr];
+        ++m_total_reads;
+        const value_t current = peek(addr);
+        if (auto hook = m_read_hooks.find(addr); hook != m_read_hooks.end()) {
+            return hook->second(addr, current);
+        }
+        return current;
+    }
+
+    void write(address_t addr, value_t value)
+    {
+        const auto [target, operation] =
+          m_alias_decoder ? m_alias_decoder(addr) : decoded_address{addr};
+        value_t& stored = m_values[target];
+        switch (operation) {
+            case write_operation::store:
+                stored = value;
+                break;
+            case write_operation::bitwise_xor:
+                stored ^= value;
+                break;
+            case write_operation::bitwise_set:
+                stored |= value;
+                break;
+            case write_operation::bitwise_clear:
+                stored &= ~value;
+                break;
+        }
+        ++m_writes[target];
+        ++m_total_writes;
+        if (auto hook = m_write_hooks.find(target);
+            hook != m_write_hooks.end()) {
+            hook->second(target, stored);
+        }
+    }
+
+    // Access without side effects (no hooks, no statistics)
+    value_t peek(address_t addr) const
+    {
+        const auto value = m_values.find(addr);
+        return value == m_values.end() ? 0 : value->second;
+    }
+
+    void poke(address_t addr, value_t value)
+    {
+        m_values[addr] = value;
+    }
+
+    void on_read(address_t addr, read_hook hook)
+    {
+        m_read_hooks[addr] = std::move(hook);
+    }
+
+    void on_write(address_t addr, write_hook hook)
+    {
+        m_write_hooks[addr] = std::move(hook);
+    }
+
+    void set_alias_decoder(alias_decoder decoder)
+    {
+        m_alias_decoder = std::move(decoder);
+    }
+
+    std::size_t reads(address_t addr) const
+    {
+        const auto count = m_reads.find(addr);
+        return count == m_reads.end() ? 0 : count->second;
+    }
+
+    std::size_t writes(address_t addr) const
+    {
+        const auto count = m_writes.find(addr);
+        return count == m_writes.end() ? 0 : count->second;
+    }
+
+    std::size_t total_reads() const
+    {
+        return m_total_reads;
+    }
+
+    std::size_t total_writes() const
+    {
+        return m_total_writes;
+    }
+
+    void reset_statistics()
+    {
+        m_reads.clear();
+        m_writes.clear();
+        m_total_reads = 0;
+        m_total_writes = 0;
+    }
+
+    // Restore the power-on state (values, hooks, statistics)
+    void reset()
+    {
+        m_values.clear();
+        m_read_hooks.clear();
+        m_write_hooks.clear();
+        m_alias_decoder = nullptr;
+        reset_statistics();
+    }
+
+  private:
+    std::unordered_map<address_t, value_t> m_values;
+    std::unordered_map<address_t, read_hook> m_read_hooks;
+    std::unordered_map<address_t, write_hook> m_write_hooks;
+    std::unordered_map<address_t, std::size_t> m_reads;
+    std::unordered_map<address_t, std::size_t> m_writes;
+    std::size_t m_total_reads = 0;
+    std::size_t m_total_writes = 0;
+    alias_decoder m_alias_decoder;
+};
+
+inline register_file& registers()
+{
+    static register_file instance;
+    return instance;
+}
+
+// Simulated core instructions (see cortex_m0plus.hpp)
+struct core
+{
+    using interrupt_state_t = bool;
+
+    // Called on every WFE/WFI, e.g. to advance the simulated time
+    static inline std::function<void()> on_wait;
+
+    static inline bool interrupts_enabled = true;
+
+    static interrupt_state_t save_and_disable_interrupts()
+    {
+        return std::exchange(interrupts_enabled, false);
+    }
+
+    static void restore_interrupts(interrupt_state_t enabled)
+    {
+        interrupts_enabled = enabled;
+    }
+
+    static void wait_for_event()
+    {
+        if (on_wait) {
+            on_wait();
+        }
+    }
+
+    static void wait_for_interrupt()
+    {
+        wait_for_event();
+    }
+
+    static void send_event()
+    {
+    }
+
+    static constexpr std::uint32_t max_delay_cycles = (255 * 3) + 2;
+
+    // Total number of cycles spent in delay_cycles()
+    static inline std::uint64_t delayed_cycles = 0;
+
+    template<std::uint32_t Cycles>
+    static void delay_cycles()
+    {
+        static_assert(Cycles <= max_delay_cycles);
+        delayed_cycles += Cycles;
+    }
+};
+
+}
+
+namespace hwio {
+
+// Register access backend using the simulated register file
+struct simulated
+{
+    template<typename RegPtrType>
+    static std::remove_cv_t<RegPtrType> read(auto addr)
+    {
+        return static_cast<std::remove_cv_t<RegPtrType>>(
+          simulator::registers().read(addr));
+    }
+
+    template<typename RegPtrType>
+    static void write(auto addr, std::remove_cv_t<RegPtrType> value)
+    {
+        simulator::registers().write(addr,
+                                     static_cast<simulator::value_t>(value));
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,95 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef IRQ_HPP
+#define IRQ_HPP
+
+#include <concepts>
+
+#include "rp2040.hpp"
+
+// Interrupt lines of the NVIC. Handlers are installed by defining a function
+// with the name from the vector table (see src/interrupts.cpp), e.g.:
+//
+//     extern "C" void io_irq_bank0_isr() { ... }
+namespace irq {
+using irqs = platform::irqs;
+
+// Clears the pending state before enabling, a stale request does not fire
+constexpr static void enable(const std::same_as<irqs> auto... irq)
+{
+    const auto mask = static_cast<platform::reg_val_t>(bitmask(irq...));
+    platform::nvic::icpr::set_value(mask);
+    platform::nvic::iser::set_value(mask);
+}
+
+constexpr static void disable(const std::same_as<irqs> auto... irq)
+{
+    platform::nvic::icer::set_value(
+      static_cast<platform::reg_val_t>(bitmask(irq...)));
+}
+
+constexpr static void set_pending(const std::same_as<irqs> auto... irq)
+{
+    platform::nvic::ispr::set_value(
+      static_cast<platform::reg_val_t>(bitmask(irq...)));
+}
+
+constexpr static void clear_pending(const std::same_as<irqs> auto... irq)
+{
+    platform::nvic::icpr::set_value(
+      static_cast<platform::reg_val_t>(bitmask(irq...)));
+}
+
+constexpr static bool is_enabled(irqs irq)
+{
+    return platform::nvic::iser::get_bit(irq);
+}
+
+constexpr static bool is_pending(irqs irq)
+{
+    return platform::nvic::ispr::get_bit(irq);
+}
+
+// Masks all interrupts for the lifetime of the object (nesting is allowed)
+class critical_section
+{
+  public:
+    critical_section()
+      : m_state(board::core::save_and_disable_interrupts())
+    {
+    }
+
+    ~critical_section()
+    {
+        board::core::restore_interrupts(m_state);
+    }
+
+    critical_section(const critical_section&) = delete;
+    critical_section& operator=(const critical_section&) = delete;
+
+  private:
+    board::core::interrupt_state_t m_state;
+};
+}
+
+#endif
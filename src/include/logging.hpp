@@ -0,0 +1,331 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef LOGGING_HPP
+#define LOGGING_HPP
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+#include "format.hpp"
+#include "irq.hpp"
+#include "ring.hpp"
+#include "timer.hpp"
+
+// Deferred binary logging - the text is formatted on the host:
+//
+//     logging::info<"adc={} t={}">(sample, format::fixed<1>{temperature});
+//     ...
+//     logging::drain(uart::uart0_tag);  // e.g. in the main loop
+//
+// Every message (the level, the argument types and the format string) is
+// stored in the ELF only - cross/armv6-m/rp2040.ld collects them in the
+// non-loaded (INFO) section .regalis_log. A log call sends a record:
+//
+//     <size> <id> <argument>... <timestamp>
+//
+//   size      - number of bytes following the size (one byte)
+//   id        - offset of the message from detail::anchor (varint)
+//   argument  - integers, characters and booleans as varints, signed
+//               integers and format::fixed as zigzag varints
+//   timestamp - microseconds since the previous record (varint, the lower
+//               32 bits of timer::ticks_since_start())
+//
+// tools/log_decode.py looks the messages up in the ELF and prints the text.
+// The format strings are checked at compile time (see format.hpp), strings
+// cannot be used as arguments.
+namespace logging {
+
+enum class level : char
+{
+    debug = 'D',
+    info = 'I',
+    warning = 'W',
+    error = 'E',
+};
+
+// A string literal used as a template argument
+template<std::size_t Size>
+struct message_text
+{
+    consteval message_text(const char (&text)[Size])
+    {
+        std::copy_n(text, Size, data);
+    }
+
+    char data[Size];
+};
+
+// The longest encoding of a 32-bit value
+constexpr std::size_t max_varint_size = 5;
+
+constexpr uint32_t zigzag(int32_t value)
+{
+    return (static_cast<uint32_t>(value) << 1) ^
+           static_cast<uint32_t>(value >> 31);
+}
+
+// Little-endian base 128, the highest bit marks a continuation
+//
+// @return number of bytes written
+constexpr std::size_t encode_varint(std::byte* output, uint32_t value)
+{
+    std::size_t size = 0;
+    while (value >= 0x80) {
+        output[size++] = static_cast<std::byte>(value | 0x80);
+        value >>= 7;
+    }
+    output[size++] = static_cast<std::byte>(value);
+    return size;
+}
+
+template<typename T>
+concept sink = requires(std::span<const std::byte> data) { T::write(data); };
+
+namespace detail {
+
+// Argument types stored with the message: unsigned, signed (zigzag),
+// character, boolean and f<decimals> (zigzag)
+template<typename T>
+consteval std::string_view type_code()
+{
+    using value_t = std::remove_cvref_t<T>;
+    if constexpr (format::detail::is_fixed<value_t>) {
+        return std::string_view{"f0f1f2f3f4f5f6f7f8f9"}.substr(
+          value_t::decimals * 2, 2);
+    } else if constexpr (std::same_as<value_t, bool>) {
+        return "b";
+    } else if constexpr (std::same_as<value_t, char>) {
+        return "c";
+    } else {
+        static_assert(std::integral<value_t> &&
+                        sizeof(value_t) <= sizeof(uint32_t),
+                      "Only integers up to 32 bits, characters, booleans and "
+                      "format::fixed can be logged");
+        return std::is_signed_v<value_t> ? "i" : "u";
+    }
+}
+
+template<typename T>
+constexpr uint32_t wire_value(const T& value)
+{
+    using value_t = std::remove_cvref_t<T>;
+    if constexpr (format::detail::is_fixed<value_t>) {
+        return zigzag(value.value);
+    } else if constexpr (std::same_as<value_t, char>) {
+        return static_cast<unsigned char>(value);
+    } else if constexpr (std::is_signed_v<value_t>) {
+        return zigzag(static_cast<int32_t>(value));
+    } else {
+        return static_cast<uint32_t>(value);
+    }
+}
+
+// "<level><types>:<format string>\0"
+template<level Level, message_text Text, typename... Args>
+consteval auto make_entry()
+{
+    constexpr std::size_t types = (std::size_t{0} + ... +
+                                   type_code<Args>().size());
+    std::array<char, types + sizeof(Text.data) + 2> entry{};
+    auto output = entry.begin();
+    *output++ = static_cast<char>(Level);
+    ((output = std::ranges::copy(type_code<Args>(), output).out), ...);
+    *output++ = ':';
+    std::ranges::copy(Text.data, output);
+    return entry;
+}
+
+// Every message lives in its own .rodata.<mangled name> section (the
+// section attribute is ignored for template instances)
+template<level Level, message_text Text, typename... Args>
+inline constexpr auto entry = make_entry<Level, Text, Args...>();
+
+// The first object of .regalis_log
+inline constexpr char anchor[] = "";
+
+inline uint32_t id_of(const char* message)
+{
+    return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(message) -
+                                 reinterpret_cast<uintptr_t>(anchor));
+}
+
+}
+
+// Records are kept in a ring buffer until drained to a sink. write() can be
+// called from any context (including interrupt handlers), the ring is
+// modified with interrupts disabled. drain() must be called from a single
+// context only.
+//
+// A record which does not fit is dropped. The number of dropped records is
+// reported with a warning as soon as there is room again.
+template<std::size_t Capacity>
+class deferred
+{
+  public:
+    static constexpr std::size_t max_arguments = 16;
+
+    template<level Level, message_text Text, typename... Args>
+    static void write(const Args&... args)
+    {
+        static_assert(sizeof...(Args) <= max_arguments,
+                      "Too many arguments");
+        [[maybe_unused]] constexpr format::basic_format_string<Args...>
+          checked{Text.data};
+
+        // The size, the ID, the arguments and the timestamp
+        std::array<std::byte, 1 + ((sizeof...(Args) + 2) * max_varint_size)>
+          record;
+        std::size_t size = 1;
+        const auto& message = detail::entry<Level, Text, Args...>;
+        size += encode_varint(&record[size], detail::id_of(message.data()));
+        ((size += encode_varint(&record[size], detail::wire_value(args))), ...);
+        commit(record, size);
+    }
+
+    // Sends all the records to the sink
+    //
+    // @return number of bytes sent
+    template<sink Sink>
+    static std::size_t drain(const Sink&)
+    {
+        std::array<std::byte, 32> chunk;
+        std::size_t total = 0;
+        while (const auto count = m_ring.pop(std::span{chunk})) {
+            Sink::write(std::span<const std::byte>{chunk.data(), count});
+            total += count;
+        }
+        return total;
+    }
+
+    // Number of bytes waiting in the buffer
+    static std::size_t pending()
+    {
+        return m_ring.size();
+    }
+
+    // Total number of records dropped
+    static uint32_t dropped()
+    {
+        return m_dropped;
+    }
+
+  private:
+    // Appends the timestamp, stores the record or drops it
+    static void commit(std::span<std::byte> record, std::size_t size)
+    {
+        irq::critical_section lock;
+        const uint32_t now = timer::clock::now_lo();
+        if (m_unreported != 0 && !report_dropped(now)) {
+            drop();
+            return;
+        }
+        size += encode_varint(&record[size], now - m_last);
+        if (!store(record.first(size))) {
+            drop();
+            return;
+        }
+        m_last = now;
+    }
+
+    static bool report_dropped(uint32_t now)
+    {
+        std::array<std::byte, 1 + (3 * max_varint_size)> record;
+        std::size_t size = 1;
+        const auto& message =
+          detail::entry<level::warning, "{} log records dropped", uint32_t>;
+        size += encode_varint(&record[size], detail::id_of(message.data()));
+        size += encode_varint(&record[size], m_unreported);
+        size += encode_varint(&record[size], now - m_last);
+        if (!store(std::span{record}.first(size))) {
+            return false;
+        }
+        m_last = now;
+        m_unreported = 0;
+        return true;
+    }
+
+    // All or nothing, the first byte is set to the size of the rest
+    static bool store(std::span<std::byte> record)
+    {
+        if (Capacity - m_ring.size() < record.size()) {
+            return false;
+        }
+        record[0] = static_cast<std::byte>(record.size() - 1);
+        m_ring.push(std::span<const std::byte>{record});
+        return true;
+    }
+
+    static void drop()
+    {
+        ++m_unreported;
+        ++m_dropped;
+    }
+
+    static inline ring::spsc<std::byte, Capacity> m_ring;
+    static inline uint32_t m_last = 0;
+    static inline uint32_t m_unreported = 0;
+    static inline uint32_t m_dropped = 0;
+};
+
+// The buffer used by the functions below
+using buffer = deferred<1024>;
+
+template<message_text Text, typename... Args>
+void debug(const Args&... args)
+{
+    buffer::write<level::debug, Text>(args...);
+}
+
+template<message_text Text, typename... Args>
+void info(const Args&... args)
+{
+    buffer::write<level::info, Text>(args...);
+}
+
+template<message_text Text, typename... Args>
+void warning(const Args&... args)
+{
+    buffer::write<level::warning, Text>(args...);
+}
+
+template<message_text Text, typename... Args>
+void error(const Args&... args)
+{
+    buffer::write<level::error, Text>(args...);
+}
+
+template<sink Sink>
+std::size_t drain(const Sink& output)
+{
+    return buffer::drain(output);
+}
+
+}
+
+#endif
@@ -25,6 +25,7 @@
 #include "gpio.hpp"
 #include "hwio.hpp"
 #include "rp2040.hpp"
+#include "shadowed.hpp"
 
 #include <limits>
 #include <type_traits>
@@ -87,9 +88,10 @@ constexpr frequency_config get_frequency_config_for(uint32_t target_frequency)
 
 constexpr uint32_t get_frequency_from_config(frequency_config config)
 {
-    return (board::clocks::sys_clk_hz /
-            ((config.wrap + 1UL) *
-             (config.integer_divisor + (config.fractional_divisor / 16UL))));
+    const uint32_t wrap = config.wrap + 1U;
+    const uint32_t divisor =
+      config.integer_divisor + (config.fractional_divisor / 16U);
+    return static_cast<uint32_t>(board::clocks::sys_clk_hz / (wrap * divisor));
 }
 
 namespace detail {
@@ -131,12 +133,12 @@ struct pwm_slice
 
     static constexpr void enable()
     {
-        descriptor::csr::set_bits(platform::pwm::csr_bits::en);
+        descriptor::csr::atomic_set_bits(platform::pwm::csr_bits::en);
     }
 
     static constexpr void disable()
     {
-        descriptor::csr::reset_bits(platform::pwm::csr_bits::en);
+        descriptor::csr::atomic_clear_bits(platform::pwm::csr_bits::en);
     }
 
     static constexpr void set_clkdiv_mode(clkdiv_mode mode)
@@ -154,6 +156,25 @@ struct pwm_slice
     }
 };
 
+// Descriptor of a PWM slice with the configuration registers (CSR, DIV, CC,
+// TOP) cached in RAM - updates of the channel levels, the divider or the
+// wrap value perform a single store (no read over the peripheral bus).
+//
+// All accesses to the slice must use the shadowed descriptor. The phase
+// retard/advance strobes of CSR are not kept in the shadow.
+template<typename T>
+struct shadowed_descriptor : T
+{
+    using csr =
+      hwio::shadowed<typename T::csr,
+                     0x00000000,
+                     bitmask(platform::pwm::csr_bits::ph_ret,
+                             platform::pwm::csr_bits::ph_adv)>;
+    using div = hwio::shadowed<typename T::div, 0x00000010>;
+    using cc = hwio::shadowed<typename T::cc, 0x00000000>;
+    using top = hwio::shadowed<typename T::top, 0x0000ffff>;
+};
+
 template<platform::pins Pin>
 struct slice_for_pin
 {
@@ -200,6 +221,12 @@ using slice5 = detail::pwm_slice<platform::pwm::ch5>;
 using slice6 = detail::pwm_slice<platform::pwm::ch6>;
 using slice7 = detail::pwm_slice<platform::pwm::ch7>;
 
+// Slices with the configuration registers cached in RAM (see
+// detail::shadowed_descriptor)
+template<typename Slice>
+using shadowed = detail::pwm_slice<
+  detail::shadowed_descriptor<typename Slice::descriptor>>;
+
 template<platform::pins Pin>
 using slice_for_pin = detail::slice_for_pin<Pin>::type;
 
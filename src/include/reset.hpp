@@ -22,6 +22,7 @@
 #ifndef __RESET_HPP__
 #define __RESET_HPP__
 
+#include "busy_wait.hpp"
 #include "rp2040.hpp"
 
 namespace reset {
@@ -29,19 +30,21 @@ using subsystems = platform::registers::reset_bits;
 
 constexpr static void reset_subsystem(subsystems subsystem)
 {
-    platform::registers::reset::set_bits(subsystem);
+    platform::registers::reset::atomic_set_bits(subsystem);
 }
 
 constexpr static void release_subsystem(subsystems subsystem)
 {
-    platform::registers::reset::reset_bits(subsystem);
+    platform::registers::reset::atomic_clear_bits(subsystem);
 }
 
-constexpr static void release_subsystem_wait(subsystems subsystem)
+[[nodiscard]] inline busy_wait::result release_subsystem_wait(
+  subsystems subsystem)
 {
     release_subsystem(subsystem);
-    while (!platform::registers::reset_done::get_bit(subsystem)) {
-    }
+    return busy_wait::until(busy_wait::sites::reset_done, [subsystem] {
+        return platform::registers::reset_done::get_bit(subsystem);
+    });
 }
 }
 
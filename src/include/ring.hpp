@@ -0,0 +1,149 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef RING_HPP
+#define RING_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace ring {
+
+// Lock-free single-producer, single-consumer ring buffer (e.g. between an
+// interrupt handler and the main loop).
+//
+// The indices run freely and wrap around at 2^32, a power-of-two capacity
+// turns both the wrap and the modulo into a single AND. Only the producer
+// stores m_head, only the consumer stores m_tail - the acquire/release pairs
+// publish the elements without disabling interrupts.
+template<typename T, std::size_t Capacity>
+class spsc
+{
+  public:
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "The capacity must be a power of two");
+    static_assert(Capacity <= (1UL << 31), "The capacity is too big");
+    static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+    using value_type = T;
+
+    static constexpr std::size_t capacity()
+    {
+        return Capacity;
+    }
+
+    // Producer side
+    bool push(const T& value)
+    {
+        const uint32_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        m_data[head & mask] = value;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Producer side, stores as many elements as fit
+    //
+    // @return number of elements stored
+    std::size_t push(std::span<const T> values)
+    {
+        const uint32_t head = m_head.load(std::memory_order_relaxed);
+        const uint32_t used = head - m_tail.load(std::memory_order_acquire);
+        const auto count =
+          std::min<std::size_t>(values.size(), Capacity - used);
+        // Up to the end of the storage, then from the beginning
+        const std::size_t start = head & mask;
+        const std::size_t first = std::min(count, Capacity - start);
+        std::copy_n(values.begin(), first, m_data.begin() + start);
+        std::copy_n(values.begin() + static_cast<std::ptrdiff_t>(first),
+                    count - first,
+                    m_data.begin());
+        m_head.store(head + static_cast<uint32_t>(count),
+                     std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side
+    bool pop(T& value)
+    {
+        const uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        if (m_head.load(std::memory_order_acquire) == tail) {
+            return false;
+        }
+        value = m_data[tail & mask];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side, takes as many elements as available
+    //
+    // @return number of elements taken
+    std::size_t pop(std::span<T> values)
+    {
+        const uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        const uint32_t used = m_head.load(std::memory_order_acquire) - tail;
+        const auto count = std::min<std::size_t>(values.size(), used);
+        const std::size_t start = tail & mask;
+        const std::size_t first = std::min(count, Capacity - start);
+        std::copy_n(m_data.begin() + start, first, values.begin());
+        std::copy_n(m_data.begin(),
+                    count - first,
+                    values.begin() + static_cast<std::ptrdiff_t>(first));
+        m_tail.store(tail + static_cast<uint32_t>(count),
+                     std::memory_order_release);
+        return count;
+    }
+
+    // Exact on the producer or consumer side, a snapshot otherwise
+    std::size_t size() const
+    {
+        return m_head.load(std::memory_order_acquire) -
+               m_tail.load(std::memory_order_acquire);
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    bool full() const
+    {
+        return size() == Capacity;
+    }
+
+  private:
+    static constexpr uint32_t mask = Capacity - 1;
+
+    std::atomic<uint32_t> m_head = 0;
+    std::atomic<uint32_t> m_tail = 0;
+    std::array<T, Capacity> m_data{};
+};
+
+}
+
+#endif
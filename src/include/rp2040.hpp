@@ -23,21 +23,62 @@
 #define RP2040_HPP
 
 #include <cstdint>
+#include <type_traits>
 #include <utility>
 
 #include "bitops.hpp"
 #include "hwio.hpp"
+#include "hwio_instrumentation.hpp"
 
 namespace platform {
 using reg_val_t = uint32_t;
 using reg_ptr_t = uint32_t;
 
+// The second stage bootloader runs from SRAM before the flash is mapped and
+// before .bss is initialized - registers it uses (XIP, XIP_SSI, QSPI pads and
+// VTOR) are never instrumented.
+constexpr bool used_by_boot_stage_2(reg_ptr_t addr)
+{
+    constexpr reg_ptr_t xip_window_start = 0x10000000;
+    constexpr reg_ptr_t xip_window_end = 0x20000000;
+    constexpr reg_ptr_t pads_qspi_start = 0x40020000;
+    constexpr reg_ptr_t pads_qspi_end = 0x40021000;
+    constexpr reg_ptr_t vtor = 0xe000ed08;
+    return (addr >= xip_window_start && addr < xip_window_end) ||
+           (addr >= pads_qspi_start && addr < pads_qspi_end) || addr == vtor;
+}
+
+template<reg_ptr_t Addr>
+using register_backend_for =
+  std::conditional_t<used_by_boot_stage_2(Addr),
+                     hwio::uninstrumented_t<board::register_backend>,
+                     board::register_backend>;
+
 template<reg_ptr_t Base,
          reg_ptr_t Offset,
          typename BitsType = unsigned int,
          hwio::hwio_region... Region>
-using reg_base =
-  hwio::volatile_reg<reg_ptr_t, reg_val_t, Base, Offset, BitsType, Region...>;
+using reg_base = hwio::volatile_reg<reg_ptr_t,
+                                    reg_val_t,
+                                    Base,
+                                    Offset,
+                                    BitsType,
+                                    register_backend_for<Base + Offset>,
+                                    Region...>;
+
+// Every register of the APB and AHB-Lite peripherals has three write-only
+// aliases: XOR (+0x1000), SET (+0x2000) and CLR (+0x3000). SIO, PPB and
+// XIP_SSI registers do not support them.
+constexpr bool supports_atomic_aliases(reg_ptr_t base)
+{
+    return base >= 0x40000000 && base < 0x60000000;
+}
+
+template<reg_ptr_t Base>
+using atomic_aliases_for =
+  std::conditional_t<supports_atomic_aliases(Base),
+                     hwio::atomic_aliases<reg_ptr_t, 0x1000, 0x2000, 0x3000>,
+                     hwio::no_atomic_aliases>;
 
 template<reg_ptr_t Base,
          reg_ptr_t Offset,
@@ -49,12 +90,14 @@ template<reg_ptr_t Base,
          reg_ptr_t Offset,
          typename BitsType = unsigned int,
          hwio::hwio_region... Region>
-using rw_reg = hwio::rw<reg_base<Base, Offset, BitsType, Region...>>;
+using rw_reg = hwio::rw<reg_base<Base, Offset, BitsType, Region...>,
+                        atomic_aliases_for<Base>>;
 
 template<reg_ptr_t Addr,
          typename BitsType = unsigned int,
          hwio::hwio_region... Region>
-using rw_reg_direct = hwio::rw<reg_base<Addr, 0, BitsType, Region...>>;
+using rw_reg_direct = hwio::rw<reg_base<Addr, 0, BitsType, Region...>,
+                               atomic_aliases_for<Addr>>;
 
 enum class pins : platform::reg_val_t
 {
@@ -108,6 +151,7 @@ constexpr static platform::reg_ptr_t timer_base = 0x40054000;
 constexpr static platform::reg_ptr_t uart0_base = 0x40034000;
 constexpr static platform::reg_ptr_t uart1_base = 0x40038000;
 constexpr static platform::reg_ptr_t pwm_base = 0x40050000;
+constexpr static platform::reg_ptr_t dma_base = 0x50000000;
 
 // TODO: move to a dedicated header file
 constexpr static platform::reg_ptr_t m0plus_vtor_offset = 0xed08;
@@ -137,6 +181,29 @@ using gpio_ctrl = rw_reg_direct<addrs::gpio_ctrl_for<pin_no>::addr>;
 template<platform::pins pin_no>
 using gpio_status = rw_reg_direct<addrs::gpio_status_for<pin_no>::addr>;
 
+// IO_BANK0 interrupts - 4 events per pin, 8 pins per register
+template<platform::pins pin_no>
+struct gpio_interrupt_for
+{
+    constexpr static reg_val_t events_per_pin = 4;
+    constexpr static reg_val_t pins_per_register = 8;
+    constexpr static reg_val_t index = bit_pos(pin_no) / pins_per_register;
+    constexpr static reg_val_t shift =
+      (bit_pos(pin_no) % pins_per_register) * events_per_pin;
+};
+
+template<reg_val_t index>
+using gpio_intr = rw_reg<addrs::io_bank0_base, 0x0f0 + (index * 4)>;
+
+template<reg_val_t index>
+using gpio_proc0_inte = rw_reg<addrs::io_bank0_base, 0x100 + (index * 4)>;
+
+template<reg_val_t index>
+using gpio_proc0_intf = rw_reg<addrs::io_bank0_base, 0x110 + (index * 4)>;
+
+template<reg_val_t index>
+using gpio_proc0_ints = ro_reg<addrs::io_bank0_base, 0x120 + (index * 4)>;
+
 using cpuid = rw_reg<addrs::sio_base, 0>;
 
 using gpio_in = rw_reg<addrs::sio_base, 0x004>;
@@ -1085,10 +1152,36 @@ using tick = rw_reg<registers::addrs::watchdog_base,
 }
 
 namespace timer {
+enum class alarm_bits : reg_val_t
+{
+    alarm0 = 0,
+    alarm1,
+    alarm2,
+    alarm3,
+};
+
+using armed_bits = alarm_bits;
+using intr_bits = alarm_bits;
+using inte_bits = alarm_bits;
+using intf_bits = alarm_bits;
+using ints_bits = alarm_bits;
+
 using timehr = ro_reg<registers::addrs::timer_base, 0x08>;
 using timelr = ro_reg<registers::addrs::timer_base, 0x0c>;
+
+// Writing the lower 32 bits of the target time arms the alarm, it fires when
+// TIMERAWL matches the value
+template<reg_val_t index>
+using alarm = rw_reg<registers::addrs::timer_base, 0x10 + (index * 4)>;
+
+// Write 1 to disarm
+using armed = rw_reg<registers::addrs::timer_base, 0x20, armed_bits>;
 using timerawh = ro_reg<registers::addrs::timer_base, 0x24>;
 using timerawl = ro_reg<registers::addrs::timer_base, 0x28>;
+using intr = rw_reg<registers::addrs::timer_base, 0x34, intr_bits>;
+using inte = rw_reg<registers::addrs::timer_base, 0x38, inte_bits>;
+using intf = rw_reg<registers::addrs::timer_base, 0x3c, intf_bits>;
+using ints = rw_reg<registers::addrs::timer_base, 0x40, ints_bits>;
 }
 
 namespace uart {
@@ -1499,6 +1592,246 @@ using ints = rw_reg<registers::addrs::pwm_base, 0xb0, en_bits>;
 
 }
 
+namespace dma {
+
+enum class ctrl_bits : reg_val_t
+{
+    en = 0,
+    high_priority,
+    data_size0,
+    data_size1,
+    incr_read,
+    incr_write,
+    ring_size0,
+    ring_size1,
+    ring_size2,
+    ring_size3,
+    ring_sel,
+    chain_to0,
+    chain_to1,
+    chain_to2,
+    chain_to3,
+    treq_sel0,
+    treq_sel1,
+    treq_sel2,
+    treq_sel3,
+    treq_sel4,
+    treq_sel5,
+    irq_quiet,
+    bswap,
+    sniff_en,
+    busy,
+    write_error = 29,
+    read_error,
+    ahb_error,
+};
+
+enum class ctrl_region_data_size_values : reg_val_t
+{
+    size_byte = 0,
+    size_halfword,
+    size_word,
+};
+
+// Data requests pacing the transfers
+enum class ctrl_region_treq_sel_values : reg_val_t
+{
+    pio0_tx0 = 0,
+    pio0_tx1,
+    pio0_tx2,
+    pio0_tx3,
+    pio0_rx0,
+    pio0_rx1,
+    pio0_rx2,
+    pio0_rx3,
+    pio1_tx0,
+    pio1_tx1,
+    pio1_tx2,
+    pio1_tx3,
+    pio1_rx0,
+    pio1_rx1,
+    pio1_rx2,
+    pio1_rx3,
+    spi0_tx,
+    spi0_rx,
+    spi1_tx,
+    spi1_rx,
+    uart0_tx,
+    uart0_rx,
+    uart1_tx,
+    uart1_rx,
+    pwm_wrap0,
+    pwm_wrap1,
+    pwm_wrap2,
+    pwm_wrap3,
+    pwm_wrap4,
+    pwm_wrap5,
+    pwm_wrap6,
+    pwm_wrap7,
+    i2c0_tx,
+    i2c0_rx,
+    i2c1_tx,
+    i2c1_rx,
+    adc,
+    xip_stream,
+    xip_ssitx,
+    xip_ssirx,
+    timer0 = 0x3b,
+    timer1,
+    timer2,
+    timer3,
+    permanent,
+};
+
+// The address wraps on a (1 << ring_size) byte boundary (0 - no wrapping)
+using ctrl_region_ring_size = hwio::region<reg_val_t, 6, 4>;
+using ctrl_region_data_size = hwio::region<ctrl_region_data_size_values, 2, 2>;
+using ctrl_region_chain_to = hwio::region<reg_val_t, 11, 4>;
+using ctrl_region_treq_sel = hwio::region<ctrl_region_treq_sel_values, 15, 6>;
+
+enum class channel_bits : reg_val_t
+{
+    ch0 = 0,
+    ch1,
+    ch2,
+    ch3,
+    ch4,
+    ch5,
+    ch6,
+    ch7,
+    ch8,
+    ch9,
+    ch10,
+    ch11,
+};
+
+using intr_bits = channel_bits;
+using inte_bits = channel_bits;
+using intf_bits = channel_bits;
+using ints_bits = channel_bits;
+using multi_chan_trigger_bits = channel_bits;
+using chan_abort_bits = channel_bits;
+
+constexpr reg_val_t channels = 12;
+
+namespace detail {
+
+static constexpr reg_ptr_t channels_addr_diff = 0x40;
+
+template<reg_val_t channel_no>
+struct channel
+{
+    static_assert(channel_no < channels);
+
+    static constexpr reg_val_t channel_number = channel_no;
+    static constexpr reg_ptr_t channel_base_addr =
+      registers::addrs::dma_base + (channels_addr_diff * channel_no);
+
+    template<reg_ptr_t Offset>
+    using ctrl_reg = rw_reg<channel_base_addr,
+                            Offset,
+                            ctrl_bits,
+                            ctrl_region_data_size,
+                            ctrl_region_ring_size,
+                            ctrl_region_chain_to,
+                            ctrl_region_treq_sel>;
+
+    using read_addr = rw_reg<channel_base_addr, 0x00>;
+    using write_addr = rw_reg<channel_base_addr, 0x04>;
+    // Reads return the number of transfers left
+    using trans_count = rw_reg<channel_base_addr, 0x08>;
+    // A write starts the channel
+    using ctrl_trig = ctrl_reg<0x0c>;
+    // Alias 1, a write to CTRL does not start the channel
+    using al1_ctrl = ctrl_reg<0x10>;
+    // Alias 1, a write to TRANS_COUNT starts the channel
+    using al1_trans_count_trig = rw_reg<channel_base_addr, 0x1c>;
+    // Alias 3, a write to READ_ADDR starts the channel
+    using al3_read_addr_trig = rw_reg<channel_base_addr, 0x3c>;
+};
+
+}
+
+template<reg_val_t channel_no>
+using channel = detail::channel<channel_no>;
+
+using intr = rw_reg<registers::addrs::dma_base, 0x400, intr_bits>;
+using inte0 = rw_reg<registers::addrs::dma_base, 0x404, inte_bits>;
+using intf0 = rw_reg<registers::addrs::dma_base, 0x408, intf_bits>;
+using ints0 = rw_reg<registers::addrs::dma_base, 0x40c, ints_bits>;
+using inte1 = rw_reg<registers::addrs::dma_base, 0x414, inte_bits>;
+using intf1 = rw_reg<registers::addrs::dma_base, 0x418, intf_bits>;
+using ints1 = rw_reg<registers::addrs::dma_base, 0x41c, ints_bits>;
+using multi_chan_trigger =
+  rw_reg<registers::addrs::dma_base, 0x430, multi_chan_trigger_bits>;
+using chan_abort = rw_reg<registers::addrs::dma_base, 0x444, chan_abort_bits>;
+
+}
+
+namespace m0plus {
+enum class scr_bits : reg_val_t
+{
+    sleeponexit = 1,
+    sleepdeep = 2,
+    sevonpend = 4,
+};
+
+using scr = rw_reg<registers::addrs::ppb_base, 0xed10, scr_bits>;
+
+enum class syst_csr_bits : reg_val_t
+{
+    enable = 0,
+    tickint,
+    clksource,
+    countflag = 16,
+};
+
+// SysTick - 24-bit down counter
+using syst_csr = rw_reg<registers::addrs::ppb_base, 0xe010, syst_csr_bits>;
+using syst_rvr = rw_reg<registers::addrs::ppb_base, 0xe014>;
+using syst_cvr = rw_reg<registers::addrs::ppb_base, 0xe018>;
+using syst_calib = ro_reg<registers::addrs::ppb_base, 0xe01c>;
+}
+
+// Interrupt numbers as seen by the NVIC
+enum class irqs : reg_val_t
+{
+    timer_irq_0 = 0,
+    timer_irq_1,
+    timer_irq_2,
+    timer_irq_3,
+    pwm_irq_wrap,
+    usbctrl_irq,
+    xip_irq,
+    pio0_irq_0,
+    pio0_irq_1,
+    pio1_irq_0,
+    pio1_irq_1,
+    dma_irq_0,
+    dma_irq_1,
+    io_irq_bank0,
+    io_irq_qspi,
+    sio_irq_proc0,
+    sio_irq_proc1,
+    clocks_irq,
+    spi0_irq,
+    spi1_irq,
+    uart0_irq,
+    uart1_irq,
+    adc_irq_fifo,
+    i2c0_irq,
+    i2c1_irq,
+    rtc_irq,
+};
+
+namespace nvic {
+// Write 1 to set/clear - never use read-modify-write on these registers
+using iser = rw_reg<registers::addrs::ppb_base, 0xe100, irqs>;
+using icer = rw_reg<registers::addrs::ppb_base, 0xe180, irqs>;
+using ispr = rw_reg<registers::addrs::ppb_base, 0xe200, irqs>;
+using icpr = rw_reg<registers::addrs::ppb_base, 0xe280, irqs>;
+}
+
 }
 
 #endif
@@ -0,0 +1,152 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SHADOWED_HPP
+#define SHADOWED_HPP
+
+#include "bitops.hpp"
+#include "hwio.hpp"
+
+namespace hwio {
+
+// Write-through RAM copy (shadow) of a register modified by our code only
+// (e.g. configuration registers). All operations compute the new value from
+// the shadow and perform a single store - the register is never read back.
+//
+// The shadow starts with the documented reset value of the register
+// (ResetValue), use sync() if the register could have been modified
+// otherwise (e.g. by the bootloader) and reset() after resetting the
+// peripheral.
+//
+// Self-clearing (strobe) bits must be listed in StrobeMask - they are written
+// when requested, but never kept in the shadow (a later update would fire
+// them again).
+//
+// Do not use it for:
+//  * registers modified by the hardware (status bits, counters),
+//  * registers modified from different contexts (ISR, the other core)
+//    without synchronisation.
+//
+// Each instantiation owns a separate shadow, use the same type for all
+// accesses to the register.
+template<hwio_reg Reg,
+         typename Reg::reg_value_t ResetValue = 0,
+         typename Reg::reg_value_t StrobeMask = 0>
+class shadowed
+{
+  public:
+    using reg = Reg;
+    using reg_value_t = typename Reg::reg_value_t;
+    using reg_addr_t = typename Reg::reg_addr_t;
+    using bits_t = typename Reg::bits_t;
+
+    constexpr static reg_addr_t addr = Reg::addr;
+    constexpr static reg_value_t reset_value = ResetValue;
+    constexpr static reg_value_t strobe_mask = StrobeMask;
+
+    // Load the shadow from the register (a single read)
+    static void sync()
+    {
+        m_shadow = static_cast<reg_value_t>(Reg::read() & ~StrobeMask);
+    }
+
+    // Assume the reset value (no access to the register)
+    static void reset()
+    {
+        m_shadow = ResetValue;
+    }
+
+    static reg_value_t value()
+    {
+        return m_shadow;
+    }
+
+    static void set_value(reg_value_t value)
+    {
+        store(value);
+    }
+
+    static void set_bits(const valid_bit_position auto&... bit_no)
+    {
+        store(static_cast<reg_value_t>(m_shadow | bitmask(bit_no...)));
+    }
+
+    static void reset_bits(const valid_bit_position auto&... bit_no)
+    {
+        store(static_cast<reg_value_t>(m_shadow & ~bitmask(bit_no...)));
+    }
+
+    static void toggle(const valid_bit_position auto&... bit_no)
+    {
+        store(static_cast<reg_value_t>(m_shadow ^ bitmask(bit_no...)));
+    }
+
+    static void update_regions(const auto... region)
+    {
+        store(static_cast<reg_value_t>(
+          (m_shadow & ~bitwise_or(Reg::region_mask(region)...)) |
+          Reg::regions_to_register_value(region...)));
+    }
+
+    static void clear_regions(const auto... region)
+    {
+        store(static_cast<reg_value_t>(
+          m_shadow & ~bitwise_or(Reg::region_mask(region)...)));
+    }
+
+    // The atomic operations are forwarded to the register (single store to
+    // the alias), the shadow follows
+    static void atomic_set_bits(const valid_bit_position auto&... bit_no)
+        requires requires { Reg::atomic_set_bits(bit_no...); }
+    {
+        m_shadow = static_cast<reg_value_t>((m_shadow | bitmask(bit_no...)) &
+                                            ~StrobeMask);
+        Reg::atomic_set_bits(bit_no...);
+    }
+
+    static void atomic_clear_bits(const valid_bit_position auto&... bit_no)
+        requires requires { Reg::atomic_clear_bits(bit_no...); }
+    {
+        m_shadow = static_cast<reg_value_t>(m_shadow & ~bitmask(bit_no...));
+        Reg::atomic_clear_bits(bit_no...);
+    }
+
+    static void atomic_toggle(const valid_bit_position auto&... bit_no)
+        requires requires { Reg::atomic_toggle(bit_no...); }
+    {
+        m_shadow = static_cast<reg_value_t>((m_shadow ^ bitmask(bit_no...)) &
+                                            ~StrobeMask);
+        Reg::atomic_toggle(bit_no...);
+    }
+
+  private:
+    static void store(reg_value_t value)
+    {
+        m_shadow = static_cast<reg_value_t>(value & ~StrobeMask);
+        Reg::write(value);
+    }
+
+    static inline reg_value_t m_shadow = ResetValue;
+};
+
+}
+
+#endif
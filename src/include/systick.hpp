@@ -0,0 +1,101 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SYSTICK_HPP
+#define SYSTICK_HPP
+
+#include <cstdint>
+
+#include "rp2040.hpp"
+
+// SysTick as a free running counter of the processor clock (no interrupt).
+// The counter wraps every 2^24 cycles (~134ms at 125MHz) - intervals are
+// measured as differences of two readings.
+namespace systick {
+
+constexpr uint32_t counter_mask = 0xffffff;
+
+namespace detail {
+// Programs the reload value and restarts the counter from zero. RVR is only
+// loaded into the counter when it wraps - the counter is stopped first and
+// cleared (any write to CVR clears it) before it is enabled again.
+//
+// Not for the users: elapsed(), delay_cycles() and the busy_wait budgets
+// assume a free running counter wrapping at counter_mask.
+template<uint32_t Reload>
+inline void reload()
+{
+    static_assert(Reload > 0 && Reload <= counter_mask,
+                  "The SysTick reload value is 24 bits wide");
+    using namespace platform::m0plus;
+    syst_csr::set_value(0);
+    syst_rvr::set_value(Reload);
+    syst_cvr::set_value(0);
+    syst_csr::set_value(
+      static_cast<platform::reg_val_t>(bitmask(syst_csr_bits::enable,
+                                               syst_csr_bits::clksource)));
+}
+}
+
+// Starts the counter, or restores the full 24-bit range if it runs with a
+// different reload value (e.g. set up by other code)
+inline void start()
+{
+    using namespace platform::m0plus;
+    if (syst_csr::get_bit(syst_csr_bits::enable) &&
+        syst_rvr::value() == counter_mask) {
+        return;
+    }
+    detail::reload<counter_mask>();
+}
+
+inline uint32_t now()
+{
+    return platform::m0plus::syst_cvr::value();
+}
+
+// Cycles between two readings (the counter counts down)
+constexpr uint32_t elapsed(uint32_t from, uint32_t to)
+{
+    return (from - to) & counter_mask;
+}
+
+// Busy-waits for the given number of cycles. Interrupts taken while waiting
+// are accounted for, as long as each of them is shorter than 2^24 cycles.
+inline void delay_cycles(uint32_t cycles)
+{
+    start();
+    uint32_t last = now();
+    while (true) {
+        const uint32_t current = now();
+        const uint32_t passed = elapsed(last, current);
+        if (passed >= cycles) {
+            return;
+        }
+        cycles -= passed;
+        last = current;
+    }
+}
+
+}
+
+#endif
@@ -22,7 +22,9 @@
 #ifndef TIMER_HPP
 #define TIMER_HPP
 
+#include "irq.hpp"
 #include "rp2040.hpp"
+#include <algorithm>
 #include <chrono>
 
 namespace timer {
@@ -42,14 +44,159 @@ constexpr std::chrono::microseconds ticks_since_start()
     return std::chrono::microseconds{(static_cast<uint64_t>(hi) << 32) | lo};
 }
 
+// The TIMER as a std::chrono clock (microseconds since the boot).
+//
+// now() uses the raw registers: it is lock-free and safe to call from
+// interrupts and from both cores. now_latched() reads TIMELR first, which
+// latches TIMEHR (two loads instead of three), but the latch is shared -
+// the read is protected against interrupts only and must not be used from
+// both cores.
+//
+// Most of the intervals are short: now_lo() returns the lower 32 bits of the
+// time with a single load, short_deadline compares them with wrap-around
+// safe 32-bit arithmetic.
+struct clock
+{
+    using rep = std::chrono::microseconds::rep;
+    using period = std::chrono::microseconds::period;
+    using duration = std::chrono::microseconds;
+    using time_point = std::chrono::time_point<clock>;
+
+    static constexpr bool is_steady = true;
+
+    // The longest interval which can be measured with now_lo()
+    static constexpr duration max_short_interval{(1UL << 31) - 1};
+
+    static time_point now() noexcept
+    {
+        return time_point{ticks_since_start()};
+    }
+
+    static time_point now_latched() noexcept
+    {
+        irq::critical_section lock;
+        const uint32_t lo = platform::timer::timelr::value();
+        const uint32_t hi = platform::timer::timehr::value();
+        return time_point{
+          duration{(static_cast<uint64_t>(hi) << 32) | lo}};
+    }
+
+    static uint32_t now_lo() noexcept
+    {
+        return platform::timer::timerawl::value();
+    }
+};
+
+// True if the 32-bit timestamp `lhs` comes before `rhs` (the timestamps must
+// be less than 2^31 microseconds apart)
+constexpr bool is_before(uint32_t lhs, uint32_t rhs)
+{
+    return static_cast<int32_t>(lhs - rhs) < 0;
+}
+
+// A deadline up to clock::max_short_interval ahead, checked with a single
+// load and a 32-bit comparison
+class short_deadline
+{
+  public:
+    static short_deadline after(std::chrono::microseconds timeout)
+    {
+        return short_deadline{clock::now_lo() +
+                              static_cast<uint32_t>(timeout.count())};
+    }
+
+    constexpr explicit short_deadline(uint32_t at) : m_at(at) {}
+
+    bool has_expired() const
+    {
+        return !is_before(clock::now_lo(), m_at);
+    }
+
+    // Zero once expired
+    std::chrono::microseconds remaining() const
+    {
+        const auto left = static_cast<int32_t>(m_at - clock::now_lo());
+        return std::chrono::microseconds{left > 0 ? left : 0};
+    }
+
+    constexpr uint32_t at() const
+    {
+        return m_at;
+    }
+
+  private:
+    uint32_t m_at;
+};
+
 constexpr void delay(std::chrono::microseconds us)
 {
+    if (us <= clock::max_short_interval) {
+        const auto deadline = short_deadline::after(us);
+        while (!deadline.has_expired()) {
+            // wait
+        }
+        return;
+    }
     std::chrono::microseconds target_value = ticks_since_start() + us;
     while (ticks_since_start() < target_value) {
         // wait
     }
 }
 
+// The alarm used by sleep_for() and sleep_until() (timer::service rejects it
+// at compile time)
+constexpr platform::reg_val_t sleep_alarm = 3;
+
+// Arming the alarm and getting in and out of WFE takes about 100 cycles
+// (every TIMER access stalls on the APB bridge), shorter waits are spun
+constexpr std::chrono::microseconds sleep_spin_threshold{
+  std::max(2UL, (4 * 100 * 1'000'000UL) / board::clocks::sys_clk_hz)};
+
+// Waits in WFE until the deadline - interrupts are still serviced while
+// sleeping. The alarm interrupt is never taken (it is disabled in the NVIC),
+// it only wakes the core up through SEVONPEND.
+inline void sleep_until(std::chrono::microseconds deadline)
+{
+    using namespace platform::timer;
+    constexpr platform::reg_val_t alarm_mask = 1U << sleep_alarm;
+    constexpr auto alarm_irq = static_cast<platform::irqs>(
+      std::to_underlying(platform::irqs::timer_irq_0) + sleep_alarm);
+    // The alarm compares 32 bits only
+    constexpr auto max_alarm_delay = clock::max_short_interval;
+
+    platform::m0plus::scr::set_bits(platform::m0plus::scr_bits::sevonpend);
+    inte::atomic_set_mask(alarm_mask);
+
+    for (auto now = ticks_since_start(); now < deadline;
+         now = ticks_since_start()) {
+        if (deadline - now < sleep_spin_threshold) {
+            delay(deadline - now);
+            break;
+        }
+        const short_deadline target{static_cast<platform::reg_val_t>(
+          std::min(deadline, now + max_alarm_delay).count())};
+        intr::set_value(alarm_mask);
+        irq::clear_pending(alarm_irq);
+        platform::timer::alarm<sleep_alarm>::set_value(target.at());
+        // Other events wake the core up as well, the alarm compares for
+        // equality - it may have been missed while being programmed
+        while (!intr::get_bit(static_cast<alarm_bits>(sleep_alarm)) &&
+               !target.has_expired()) {
+            board::core::wait_for_event();
+        }
+    }
+
+    inte::atomic_clear_mask(alarm_mask);
+    armed::set_value(alarm_mask);
+    intr::set_value(alarm_mask);
+    irq::clear_pending(alarm_irq);
+}
+
+inline void sleep_for(std::chrono::microseconds duration)
+{
+    sleep_until(ticks_since_start() + duration);
+}
+
 }
 
 #endif
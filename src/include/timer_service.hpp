@@ -0,0 +1,469 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef TIMER_SERVICE_HPP
+#define TIMER_SERVICE_HPP
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "bitops.hpp"
+#include "irq.hpp"
+#include "rp2040.hpp"
+#include "timer.hpp"
+
+namespace timer {
+
+enum class dispatch
+{
+    // Callbacks are called from the alarm interrupt
+    from_isr,
+    // Expired timers are queued, callbacks are called by service::poll()
+    deferred,
+};
+
+template<platform::reg_val_t Alarm, dispatch Dispatch, std::size_t Levels>
+class service;
+
+// A software timer, the storage is provided by the user (no allocations). The
+// object must stay alive and must not be moved while it is active.
+class software_timer
+{
+  public:
+    using callback_t = void (*)(software_timer&);
+
+    constexpr explicit software_timer(callback_t callback)
+      : m_callback(callback)
+    {
+    }
+
+    software_timer(const software_timer&) = delete;
+    software_timer& operator=(const software_timer&) = delete;
+
+    constexpr bool is_active() const
+    {
+        return m_state != states::idle;
+    }
+
+    constexpr bool is_periodic() const
+    {
+        return m_period != 0;
+    }
+
+    constexpr std::chrono::microseconds deadline() const
+    {
+        return std::chrono::microseconds{m_deadline};
+    }
+
+  private:
+    template<platform::reg_val_t, dispatch, std::size_t>
+    friend class service;
+
+    enum class states : uint8_t
+    {
+        idle,
+        armed,
+        pending,
+    };
+
+    callback_t m_callback;
+    software_timer* m_next = nullptr;
+    software_timer* m_prev = nullptr;
+    uint64_t m_deadline = 0;
+    uint64_t m_period = 0;
+    uint16_t m_slot = 0;
+    states m_state = states::idle;
+};
+
+// Multiplexes any number of software timers over a single TIMER alarm using
+// a hierarchical timing wheel: `Levels` levels of 32 slots, the level N slot
+// spans 32^N microseconds. A timer is linked into the slot of the highest
+// digit (base 32) in which its deadline differs from the current time of the
+// wheel, it moves to lower levels as the time approaches the deadline.
+//
+//   - start/cancel are O(1) (an intrusive doubly linked list per slot),
+//   - the hardware alarm is programmed for the next step of the wheel only,
+//     the lowest occupied slot is found with a single countr_zero() per
+//     level,
+//   - periodic timers are rearmed relative to the previous deadline (no
+//     drift, late callbacks do not shift the following ones).
+//
+// Deadlines further than 32^Levels microseconds away (~17.9 minutes for the
+// default 6 levels) wait on an overflow list, revisited every 32^Levels
+// microseconds.
+//
+// Install the interrupt handler with:
+//
+//     using timers = timer::service<0>;
+//     extern "C" void timer_irq_0_isr() { timers::handle_alarm(); }
+template<platform::reg_val_t Alarm = 0,
+         dispatch Dispatch = dispatch::from_isr,
+         std::size_t Levels = 6>
+class service
+{
+  public:
+    static_assert(Alarm < 4, "The TIMER has four alarms");
+    static_assert(Alarm != sleep_alarm,
+                  "The alarm is used by sleep_for()/sleep_until()");
+    static_assert(Levels > 0 && Levels * 5 <= 60, "Invalid number of levels");
+
+    static constexpr platform::irqs alarm_irq = static_cast<platform::irqs>(
+      std::to_underlying(platform::irqs::timer_irq_0) + Alarm);
+
+    static void init()
+    {
+        irq::critical_section lock;
+        m_now = now();
+        platform::timer::intr::set_value(alarm_mask);
+        platform::timer::inte::atomic_set_mask(alarm_mask);
+        irq::enable(alarm_irq);
+    }
+
+    static void start(software_timer& timer, std::chrono::microseconds delay)
+    {
+        start_at(timer, ticks_since_start() + delay);
+    }
+
+    static void start_at(software_timer& timer,
+                         std::chrono::microseconds deadline)
+    {
+        irq::critical_section lock;
+        remove(timer);
+        synchronize_if_idle();
+        timer.m_period = 0;
+        timer.m_deadline = static_cast<uint64_t>(deadline.count());
+        insert(timer);
+        reschedule();
+    }
+
+    // The first expiry after `period`, then every `period` (measured from
+    // the deadlines, not from the callbacks)
+    static void start_periodic(software_timer& timer,
+                               std::chrono::microseconds period)
+    {
+        irq::critical_section lock;
+        remove(timer);
+        synchronize_if_idle();
+        timer.m_period = static_cast<uint64_t>(period.count());
+        timer.m_deadline = now() + timer.m_period;
+        insert(timer);
+        reschedule();
+    }
+
+    static void cancel(software_timer& timer)
+    {
+        irq::critical_section lock;
+        remove(timer);
+        timer.m_period = 0;
+    }
+
+    // To be called from the TIMER_IRQ_<Alarm> handler
+    static void handle_alarm()
+    {
+        platform::timer::intr::set_value(alarm_mask);
+        do {
+            while (software_timer* timer = expire_next()) {
+                run(*timer);
+            }
+        } while (!program_alarm());
+    }
+
+    // Calls the callbacks of the expired timers (deferred dispatch only)
+    static void poll()
+        requires(Dispatch == dispatch::deferred)
+    {
+        bool rearmed = false;
+        while (software_timer* timer = pop_pending()) {
+            rearmed |= run(*timer);
+        }
+        if (rearmed) {
+            irq::critical_section lock;
+            reschedule();
+        }
+    }
+
+  private:
+    static constexpr unsigned int bits_per_level = 5;
+    static constexpr std::size_t slots_per_level = 1U << bits_per_level;
+    static constexpr std::size_t overflow_slot = Levels * slots_per_level;
+    static constexpr unsigned int wheel_bits = Levels * bits_per_level;
+    static constexpr platform::reg_val_t alarm_mask = 1U << Alarm;
+
+    // The alarm compares 32 bits only
+    static constexpr uint64_t max_alarm_delay = 1ULL << 31;
+
+    struct step
+    {
+        uint64_t time;
+        std::size_t slot;
+    };
+
+    static inline uint64_t m_now = 0;
+    static inline std::array<software_timer*, overflow_slot + 1> m_slots{};
+    static inline std::array<uint32_t, Levels> m_occupied{};
+    static inline software_timer* m_pending_head = nullptr;
+    static inline software_timer* m_pending_tail = nullptr;
+
+    static uint64_t now()
+    {
+        return static_cast<uint64_t>(ticks_since_start().count());
+    }
+
+    static constexpr uint32_t digit(uint64_t time, std::size_t level)
+    {
+        return static_cast<uint32_t>(time >> (level * bits_per_level)) &
+               (slots_per_level - 1);
+    }
+
+    static std::size_t slot_for(uint64_t deadline)
+    {
+        const uint64_t diff = deadline ^ m_now;
+        if ((diff >> wheel_bits) != 0) {
+            return overflow_slot;
+        }
+        std::size_t level = 0;
+        while ((diff >> ((level + 1) * bits_per_level)) != 0) {
+            ++level;
+        }
+        return (level * slots_per_level) + digit(deadline, level);
+    }
+
+    static void insert(software_timer& timer)
+    {
+        // Deadlines in the past expire on the next step
+        timer.m_deadline = std::max(timer.m_deadline, m_now);
+        const std::size_t slot = slot_for(timer.m_deadline);
+        timer.m_slot = static_cast<uint16_t>(slot);
+        timer.m_state = software_timer::states::armed;
+        timer.m_prev = nullptr;
+        timer.m_next = m_slots[slot];
+        if (timer.m_next != nullptr) {
+            timer.m_next->m_prev = &timer;
+        }
+        m_slots[slot] = &timer;
+        if (slot != overflow_slot) {
+            m_occupied[slot / slots_per_level] |=
+              1U << (slot % slots_per_level);
+        }
+    }
+
+    static void remove(software_timer& timer)
+    {
+        using states = software_timer::states;
+        if (timer.m_state == states::armed) {
+            const std::size_t slot = timer.m_slot;
+            unlink(timer, m_slots[slot]);
+            if (m_slots[slot] == nullptr && slot != overflow_slot) {
+                m_occupied[slot / slots_per_level] &=
+                  ~(1U << (slot % slots_per_level));
+            }
+        } else if (timer.m_state == states::pending) {
+            if (m_pending_tail == &timer) {
+                m_pending_tail = timer.m_prev;
+            }
+            unlink(timer, m_pending_head);
+        }
+        timer.m_state = states::idle;
+    }
+
+    static void unlink(software_timer& timer, software_timer*& head)
+    {
+        if (timer.m_prev != nullptr) {
+            timer.m_prev->m_next = timer.m_next;
+        } else {
+            head = timer.m_next;
+        }
+        if (timer.m_next != nullptr) {
+            timer.m_next->m_prev = timer.m_prev;
+        }
+        timer.m_next = nullptr;
+        timer.m_prev = nullptr;
+    }
+
+    // The next point in time at which the wheel has something to do: a
+    // timer expires (level 0) or a slot has to be redistributed to the lower
+    // levels. Occupied slots of the level N always follow the current digit,
+    // and the lower levels always come first.
+    static bool next_step(step& next)
+    {
+        for (std::size_t level = 0; level < Levels; ++level) {
+            const uint32_t current = digit(m_now, level);
+            const uint32_t ahead =
+              (level == 0) ? ~0U << current
+                           : ((current == slots_per_level - 1)
+                                ? 0U
+                                : ~0U << (current + 1));
+            if (const uint32_t occupied = m_occupied[level] & ahead;
+                occupied != 0) {
+                const auto shift =
+                  static_cast<unsigned int>(level * bits_per_level);
+                const uint32_t slot_digit = countr_zero(occupied);
+                next.slot = (level * slots_per_level) + slot_digit;
+                next.time = ((m_now >> (shift + bits_per_level))
+                             << (shift + bits_per_level)) |
+                            (static_cast<uint64_t>(slot_digit) << shift);
+                return true;
+            }
+        }
+        if (m_slots[overflow_slot] != nullptr) {
+            next.slot = overflow_slot;
+            next.time = ((m_now >> wheel_bits) + 1) << wheel_bits;
+            return true;
+        }
+        return false;
+    }
+
+    // The wheel lost track of the time while it was empty
+    static void synchronize_if_idle()
+    {
+        const bool is_empty =
+          m_slots[overflow_slot] == nullptr &&
+          std::ranges::all_of(m_occupied, [](uint32_t occupied) {
+              return occupied == 0;
+          });
+        if (is_empty) {
+            m_now = now();
+        }
+    }
+
+    // Takes the next expired timer (from the interrupt handler), deferred
+    // timers are moved to the pending list and returned only by poll()
+    static software_timer* expire_next()
+    {
+        irq::critical_section lock;
+        while (software_timer* timer = take_expired(now())) {
+            if constexpr (Dispatch == dispatch::from_isr) {
+                return timer;
+            } else {
+                push_pending(*timer);
+            }
+        }
+        return nullptr;
+    }
+
+    // Advances the wheel up to `time`, returns the next expired timer (already
+    // removed from the wheel)
+    static software_timer* take_expired(uint64_t time)
+    {
+        step next;
+        while (next_step(next) && next.time <= time) {
+            m_now = next.time;
+            if (next.slot < slots_per_level) {
+                software_timer* timer = m_slots[next.slot];
+                remove(*timer);
+                return timer;
+            }
+            // Redistribute the slot to the lower levels
+            software_timer* timer = m_slots[next.slot];
+            m_slots[next.slot] = nullptr;
+            if (next.slot != overflow_slot) {
+                m_occupied[next.slot / slots_per_level] &=
+                  ~(1U << (next.slot % slots_per_level));
+            }
+            while (timer != nullptr) {
+                software_timer* following = timer->m_next;
+                insert(*timer);
+                timer = following;
+            }
+        }
+        return nullptr;
+    }
+
+    // Rearms a periodic timer (unless it has been restarted in the meantime)
+    // and calls the callback, returns true if the timer has been rearmed
+    static bool run(software_timer& timer)
+    {
+        bool rearmed = false;
+        {
+            irq::critical_section lock;
+            if (timer.is_periodic() && !timer.is_active()) {
+                timer.m_deadline += timer.m_period;
+                insert(timer);
+                rearmed = true;
+            }
+        }
+        timer.m_callback(timer);
+        return rearmed;
+    }
+
+    static void push_pending(software_timer& timer)
+    {
+        timer.m_state = software_timer::states::pending;
+        timer.m_next = nullptr;
+        timer.m_prev = m_pending_tail;
+        if (m_pending_tail != nullptr) {
+            m_pending_tail->m_next = &timer;
+        } else {
+            m_pending_head = &timer;
+        }
+        m_pending_tail = &timer;
+    }
+
+    static software_timer* pop_pending()
+    {
+        irq::critical_section lock;
+        software_timer* timer = m_pending_head;
+        if (timer != nullptr) {
+            remove(*timer);
+        }
+        return timer;
+    }
+
+    // Programs the alarm for the next step of the wheel, returns false if
+    // the step is already due
+    static bool program_alarm()
+    {
+        irq::critical_section lock;
+        step next;
+        if (!next_step(next)) {
+            platform::timer::armed::set_value(alarm_mask);
+            return true;
+        }
+        uint64_t current = now();
+        if (next.time <= current) {
+            return false;
+        }
+        const uint64_t target = std::min(next.time, current + max_alarm_delay);
+        platform::timer::alarm<Alarm>::set_value(
+          static_cast<platform::reg_val_t>(target));
+        // The alarm compares for equality - make sure the target was not
+        // missed while it was being programmed
+        return now() < target;
+    }
+
+    // Called (with interrupts masked) after the wheel has been modified
+    // outside of the interrupt handler
+    static void reschedule()
+    {
+        if (!program_alarm()) {
+            irq::set_pending(alarm_irq);
+        }
+    }
+};
+
+}
+
+#endif
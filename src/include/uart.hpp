@@ -23,12 +23,22 @@
 #define UART_HPP
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 #include <bits/ranges_algo.h>
+#include <cstddef>
 #include <cstdint>
+#include <span>
 #include <string_view>
 #include <tuple>
+#include <utility>
 
+#include "busy_wait.hpp"
+#include "dma.hpp"
+#include "irq.hpp"
 #include "reset.hpp"
+#include "ring.hpp"
 #include "rp2040.hpp"
 
 namespace uart {
@@ -43,6 +53,39 @@ using baudrate_calculation = std::tuple<baudrate_descriptor, uint32_t>;
 using parity = platform::uart::uartlcr_h_region_parity_values;
 using stop_bits = platform::uart::uartlcr_h_region_stop_bits_values;
 using word_length = platform::uart::uartlcr_h_region_wlen_values;
+using tx_trigger = platform::uart::uartifls_region_txiflsel_values;
+using rx_trigger = platform::uart::uartifls_region_rxiflsel_values;
+
+// Depth of both PL011 FIFOs
+constexpr std::size_t fifo_depth = 32;
+
+// Hardware flow control, the CTS/RTS pins must be switched to
+// gpio::functions::uart as well. The RX side deasserts RTS once the RX FIFO
+// reaches the rx_level trigger, the TX side stops while CTS is deasserted.
+enum class flow_control : uint8_t
+{
+    none,
+    cts,
+    rts,
+    rts_cts,
+};
+
+// Receive errors (see uart<...>::stats())
+struct statistics
+{
+    uint32_t overrun_errors = 0;
+    uint32_t break_errors = 0;
+    uint32_t parity_errors = 0;
+    uint32_t framing_errors = 0;
+};
+
+// Number of FIFO entries at the trigger level (1/8, 1/4, 1/2, 3/4, 7/8)
+template<typename Trigger>
+consteval std::size_t fifo_entries(Trigger level)
+{
+    constexpr std::array<std::size_t, 5> eighths{1, 2, 4, 6, 7};
+    return fifo_depth * eighths[std::to_underlying(level)] / 8;
+}
 
 constexpr baudrate_calculation baudrate_calculate(uint32_t requested_baudrate)
 {
@@ -69,17 +112,98 @@ constexpr baudrate_calculation baudrate_calculate(uint32_t requested_baudrate)
             real_baudrate};
 }
 
+// The divisor can not go below 1.0 (16 clk_peri cycles per bit)
+constexpr uint32_t max_baudrate(
+  uint32_t clock_hz = board::clocks::peri_clk_hz)
+{
+    return clock_hz / 16;
+}
+
+// Accepted deviation of the real baudrate, in parts per million (1%)
+constexpr uint32_t default_baudrate_tolerance_ppm = 10'000;
+
+struct baudrate_solution
+{
+    baudrate_descriptor divisors;
+    uint32_t real_baudrate;
+    // |real - requested| / requested, in parts per million
+    uint32_t error_ppm;
+    // The divisor fits in 1.0 ... 65535.0 (no clamping took place)
+    bool in_range;
+};
+
+// Solve the divisors without clamping them, see baudrate<...>() for the
+// checked version
+consteval baudrate_solution solve_baudrate(
+  uint32_t requested_baudrate,
+  uint32_t clock_hz = board::clocks::peri_clk_hz)
+{
+    if (requested_baudrate == 0) {
+        return {};
+    }
+    // clock / (16 * baudrate) in 1/64 steps, rounded to the nearest step
+    const uint64_t divisor =
+      (4 * uint64_t{clock_hz} + (requested_baudrate / 2)) / requested_baudrate;
+    if (divisor < 64 || divisor > (uint64_t{65535} << 6)) {
+        return {};
+    }
+    const auto real_baudrate =
+      static_cast<uint32_t>((4 * uint64_t{clock_hz} + (divisor / 2)) / divisor);
+    const uint64_t deviation = real_baudrate > requested_baudrate
+                                 ? real_baudrate - requested_baudrate
+                                 : requested_baudrate - real_baudrate;
+    return {
+      .divisors = {.integer_divisor = static_cast<uint32_t>(divisor >> 6),
+                   .fractional_divisor = static_cast<uint32_t>(divisor & 0x3f)},
+      .real_baudrate = real_baudrate,
+      .error_ppm =
+        static_cast<uint32_t>(deviation * 1'000'000 / requested_baudrate),
+      .in_range = true};
+}
+
+// Divisors for the baudrate, computed at compile time. Rejects baudrates which
+// are out of reach for clk_peri or deviate by more than the tolerance.
+template<uint32_t Baudrate,
+         uint32_t TolerancePpm = default_baudrate_tolerance_ppm>
+consteval baudrate_solution baudrate()
+{
+    constexpr auto solution = solve_baudrate(Baudrate);
+    static_assert(Baudrate <= max_baudrate(),
+                  "Baudrate above max_baudrate() for this clk_peri");
+    static_assert(Baudrate > max_baudrate() || solution.in_range,
+                  "Baudrate too low for this clk_peri (divisor > 65535)");
+    static_assert(solution.error_ppm <= TolerancePpm,
+                  "Baudrate error exceeds the tolerance for this clk_peri");
+    return solution;
+}
+
 namespace detail {
-template<typename T>
+template<typename T, flow_control Flow = flow_control::none>
 class uart
 {
   public:
     using descriptor = T;
 
+    static constexpr flow_control flow = Flow;
+
+    static constexpr bool is_uart0 =
+      descriptor::reset_bit == platform::registers::reset_bits::uart0;
+    static constexpr platform::irqs uart_irq =
+      is_uart0 ? platform::irqs::uart0_irq : platform::irqs::uart1_irq;
+    static constexpr dma::treq tx_dreq =
+      is_uart0 ? dma::treq::uart0_tx : dma::treq::uart1_tx;
+    static constexpr dma::treq rx_dreq =
+      is_uart0 ? dma::treq::uart0_rx : dma::treq::uart1_rx;
+
+    // FIFO levels raising the interrupts (programmed by init())
+    static constexpr tx_trigger tx_level = tx_trigger::fifo_le_1_4_full;
+    static constexpr rx_trigger rx_level = rx_trigger::fifo_le_1_2_full;
+
     /**
      * Initialize UART and configure to work at the requested baudrate.
      *
-     * @return the real configured baudrate
+     * @return the real configured baudrate, 0 if the UART did not come out of
+     * reset in time
      */
     static constexpr uint32_t init(
       uint32_t requested_baudrate,
@@ -87,18 +211,34 @@ class uart
       stop_bits stop_bits = stop_bits::one,
       parity parity = parity::odd)
     {
-        reset::reset_subsystem(descriptor::reset_bit);
-        reset::release_subsystem_wait(descriptor::reset_bit);
-
-        uint32_t real_baudrate = set_baudrate(requested_baudrate);
-        set_format(data_bits, stop_bits, parity);
-        descriptor::uartcr::set_bits(platform::uart::uartcr_bits::uarten,
-                                     platform::uart::uartcr_bits::txe,
-                                     platform::uart::uartcr_bits::rxe);
-
+        const auto& [baud, real_baudrate] =
+          baudrate_calculate(requested_baudrate);
+        if (!configure(baud, data_bits, stop_bits, parity)) {
+            return 0;
+        }
         return real_baudrate;
     };
 
+    /**
+     * Initialize UART with the divisors computed at compile time (see
+     * uart::baudrate<...>()), no division takes place at runtime.
+     *
+     * @return the real configured baudrate, 0 if the UART did not come out of
+     * reset in time
+     */
+    template<uint32_t Baudrate,
+             uint32_t TolerancePpm = default_baudrate_tolerance_ppm>
+    static uint32_t init(word_length data_bits = word_length::word_8_bits,
+                         stop_bits stop = stop_bits::one,
+                         parity parity_mode = parity::odd)
+    {
+        constexpr auto solution = baudrate<Baudrate, TolerancePpm>();
+        if (!configure(solution.divisors, data_bits, stop, parity_mode)) {
+            return 0;
+        }
+        return solution.real_baudrate;
+    }
+
     /**
      * Set baudrate
      *
@@ -108,13 +248,20 @@ class uart
     static constexpr uint32_t set_baudrate(uint32_t requested_baudrate)
     {
         const auto& [baud, real_baud] = baudrate_calculate(requested_baudrate);
-        descriptor::uartibrd::set_value(baud.integer_divisor);
-        descriptor::uartfbrd::set_value(baud.fractional_divisor);
-        // Dummy write to latch in the divisors
-        descriptor::uartlcr_h::set_value(descriptor::uartlcr_h::value());
+        write_divisors(baud);
         return real_baud;
     }
 
+    // Compile-time counterpart of set_baudrate(uint32_t)
+    template<uint32_t Baudrate,
+             uint32_t TolerancePpm = default_baudrate_tolerance_ppm>
+    static uint32_t set_baudrate()
+    {
+        constexpr auto solution = baudrate<Baudrate, TolerancePpm>();
+        write_divisors(solution.divisors);
+        return solution.real_baudrate;
+    }
+
     static constexpr void set_format(word_length data_bits,
                                      stop_bits stop_bits,
                                      parity parity)
@@ -140,7 +287,7 @@ class uart
         while (!is_writable()) {
             // wait
         }
-        descriptor::uartdr::set_value(character);
+        descriptor::uartdr::set_value(static_cast<unsigned char>(character));
     }
 
     static constexpr char getc()
@@ -148,21 +295,536 @@ class uart
         while (!is_readable()) {
             // wait
         }
-        return static_cast<char>(descriptor::uartdr::value());
+        return static_cast<char>(read_fifo());
+    }
+
+    // Reads a byte from the RX FIFO (must not be empty) and counts its
+    // errors. The upper bits of UARTDR hold the UARTRSR flags of the byte,
+    // no additional load is needed.
+    static uint8_t read_fifo()
+    {
+        using platform::uart::uartdr_bits;
+        constexpr auto errors =
+          bitmask(uartdr_bits::oe, uartdr_bits::be, uartdr_bits::pe,
+                  uartdr_bits::fe);
+        const auto value = descriptor::uartdr::value();
+        if (value & errors) [[unlikely]] {
+            count_errors(value);
+        }
+        return static_cast<uint8_t>(value);
+    }
+
+    // Counts the errors flagged in UARTRIS and clears exactly those - the
+    // receive path of uart::dma_receiver, where the DMA reads UARTDR (and the
+    // error bits with it). The flags are sticky: errors of the same kind
+    // between two polls count as one.
+    static void poll_errors()
+    {
+        using platform::uart::uartdr_bits;
+        using platform::uart::uarticr_bits;
+        using platform::uart::uartris_bits;
+        constexpr auto errors = static_cast<platform::reg_val_t>(
+          bitmask(uartris_bits::oeris, uartris_bits::beris,
+                  uartris_bits::peris, uartris_bits::feris));
+        // One bit below the error bits of UARTDR
+        static_assert((errors << 1) ==
+                      bitmask(uartdr_bits::oe, uartdr_bits::be,
+                              uartdr_bits::pe, uartdr_bits::fe));
+        static_assert(errors == bitmask(uarticr_bits::oeic,
+                                        uarticr_bits::beic,
+                                        uarticr_bits::peic,
+                                        uarticr_bits::feic));
+        const auto status = descriptor::uartris::value() & errors;
+        if (status != 0) [[unlikely]] {
+            count_errors(status << 1);
+            // Write one to clear: an error raised after the read above stays
+            // flagged for the next poll (UARTECR would clear all of them)
+            descriptor::uarticr::set_value(status);
+        }
+    }
+
+    // Receive errors counted since the start (or reset_stats()). The
+    // counters are updated by the context reading the RX FIFO - getc(),
+    // read_some(), the interrupt handler of uart::buffered or
+    // poll_errors(). The returned copy is a consistent snapshot.
+    static statistics stats()
+    {
+        irq::critical_section lock;
+        return m_statistics;
+    }
+
+    static void reset_stats()
+    {
+        irq::critical_section lock;
+        m_statistics = {};
     }
 
     static constexpr void puts(std::string_view data)
     {
-        std::ranges::for_each(data, [](char character) {
-            putc(character);
-        });
+        write(std::as_bytes(std::span{data}));
+    }
+
+    // Number of bytes which can be written without checking the flags again
+    static std::size_t tx_room()
+    {
+        using platform::uart::uartfr_bits;
+        const auto flags = descriptor::uartfr::value();
+        if (flags & bit_value(uartfr_bits::txfe)) {
+            return fifo_depth;
+        }
+        return (flags & bit_value(uartfr_bits::txff)) ? 0 : 1;
+    }
+
+    // Number of bytes which can be read without checking the flags again
+    static std::size_t rx_fill()
+    {
+        using namespace platform::uart;
+        const auto flags = descriptor::uartfr::value();
+        if (flags & bit_value(uartfr_bits::rxff)) {
+            return fifo_depth;
+        }
+        if (flags & bit_value(uartfr_bits::rxfe)) {
+            return 0;
+        }
+        return descriptor::uartris::get_bit(uartris_bits::rxris)
+                 ? fifo_entries(rx_level)
+                 : 1;
+    }
+
+    // Waits for the TX FIFO to drain and refills it with up to 32 bytes at
+    // once (one status check per burst instead of one per byte)
+    static void write(std::span<const std::byte> data)
+    {
+        while (!data.empty()) {
+            while (!descriptor::uartfr::get_bit(
+              platform::uart::uartfr_bits::txfe)) {
+                // wait
+            }
+            const auto burst = std::min(fifo_depth, data.size());
+            for (const std::byte value : data.first(burst)) {
+                descriptor::uartdr::set_value(std::to_integer<uint8_t>(value));
+            }
+            data = data.subspan(burst);
+        }
+    }
+
+    /**
+     * Sends the data with the DMA channel paced by the TX data request and
+     * returns at once (the CPU does not touch the data).
+     *
+     * The data must stay untouched until the transfer is done and the
+     * previous transfer of the channel must be finished (see dma::init()).
+     */
+    template<platform::reg_val_t Channel>
+    static dma::completion<Channel> write_dma(std::span<const std::byte> data)
+    {
+        constexpr dma::transfer_config config{.increment_write = false,
+                                              .request = tx_dreq};
+        descriptor::uartdmacr::atomic_set_bits(
+          platform::uart::uartdmacr_bits::txdmae);
+        dma::channel<Channel>::template start<config>(
+          dma::address_of(data.data()),
+          descriptor::uartdr::addr,
+          static_cast<platform::reg_val_t>(data.size()));
+        return {};
+    }
+
+    // Reads the bytes waiting in the RX FIFO (never waits)
+    //
+    // @return number of bytes read
+    static std::size_t read_some(std::span<std::byte> data)
+    {
+        std::size_t count = 0;
+        while (count < data.size()) {
+            const auto burst = std::min(rx_fill(), data.size() - count);
+            if (burst == 0) {
+                break;
+            }
+            for (std::size_t i = 0; i < burst; ++i) {
+                data[count++] = static_cast<std::byte>(read_fifo());
+            }
+        }
+        return count;
+    }
+
+  private:
+    static constexpr auto flow_control_bits = [] {
+        using platform::uart::uartcr_bits;
+        switch (Flow) {
+            case flow_control::cts:
+                return bitmask(uartcr_bits::ctsen);
+            case flow_control::rts:
+                return bitmask(uartcr_bits::rtsen);
+            case flow_control::rts_cts:
+                return bitmask(uartcr_bits::rtsen, uartcr_bits::ctsen);
+            default:
+                return 0UL;
+        }
+    }();
+
+    // @return false if the UART did not come out of reset in time
+    [[nodiscard]] static bool configure(const baudrate_descriptor& baud,
+                                        word_length data_bits,
+                                        stop_bits stop,
+                                        parity parity_mode)
+    {
+        using namespace platform::uart;
+        reset::reset_subsystem(descriptor::reset_bit);
+        if (reset::release_subsystem_wait(descriptor::reset_bit) !=
+            busy_wait::result::ready) {
+            return false;
+        }
+
+        // The write to UARTLCR_H latches the divisors (no dummy write needed)
+        hwio::transaction{
+          hwio::op::set_value<typename descriptor::uartibrd>(
+            baud.integer_divisor),
+          hwio::op::set_value<typename descriptor::uartfbrd>(
+            baud.fractional_divisor),
+          hwio::op::update_regions<typename descriptor::uartifls>(
+            uartifls_region_txiflsel{tx_level},
+            uartifls_region_rxiflsel{rx_level}),
+          hwio::ordered,
+          hwio::op::update_regions<typename descriptor::uartlcr_h>(
+            uartlcr_h_region_wlen{data_bits},
+            uartlcr_h_region_stop_bits{stop},
+            uartlcr_h_region_parity{parity_mode}),
+          hwio::op::set_bits<typename descriptor::uartlcr_h>(
+            uartlcr_h_bits::fen),
+          hwio::ordered,
+          hwio::op::set_bits<typename descriptor::uartcr>(
+            uartcr_bits::uarten, uartcr_bits::txe, uartcr_bits::rxe),
+          hwio::edit<typename descriptor::uartcr>{.mask = flow_control_bits,
+                                                  .value = flow_control_bits}}
+          .commit();
+        return true;
+    }
+
+    static void write_divisors(const baudrate_descriptor& baud)
+    {
+        descriptor::uartibrd::set_value(baud.integer_divisor);
+        descriptor::uartfbrd::set_value(baud.fractional_divisor);
+        // Dummy write to latch in the divisors
+        descriptor::uartlcr_h::set_value(descriptor::uartlcr_h::value());
+    }
+
+    static void count_errors(platform::reg_val_t value)
+    {
+        using platform::uart::uartdr_bits;
+        const auto count = [value](uartdr_bits bit) {
+            return (value & bitmask(bit)) ? 1U : 0U;
+        };
+        // The ISR and the thread may both read the FIFO (rare, errors only)
+        irq::critical_section lock;
+        m_statistics.overrun_errors += count(uartdr_bits::oe);
+        m_statistics.break_errors += count(uartdr_bits::be);
+        m_statistics.parity_errors += count(uartdr_bits::pe);
+        m_statistics.framing_errors += count(uartdr_bits::fe);
     }
+
+    static inline statistics m_statistics{};
 };
 }
 
 using uart0 = detail::uart<platform::uart::uart0>;
 using uart1 = detail::uart<platform::uart::uart1>;
 
+// With RTS/CTS flow control (use either these or the above for a given UART)
+using uart0_rts_cts =
+  detail::uart<platform::uart::uart0, flow_control::rts_cts>;
+using uart1_rts_cts =
+  detail::uart<platform::uart::uart1, flow_control::rts_cts>;
+
+// Continuous reception into a ring buffer filled by a DMA channel (the
+// write address wraps on the size of the buffer), the CPU only copies the
+// data out:
+//
+//     using receiver = uart::dma_receiver<uart::uart0, 1, 1024>;
+//     receiver::start();
+//     ...
+//     const auto count = receiver::read_some(buffer);
+//
+// The number of bytes received is derived from TRANS_COUNT of the channel.
+// When the consumer falls behind by more than Size bytes the oldest data is
+// overwritten, the lost bytes are counted. Receive errors are taken from
+// UARTRIS by read_some() (see uart<...>::poll_errors()).
+template<typename Uart, platform::reg_val_t Channel, std::size_t Size>
+class dma_receiver
+{
+  public:
+    static_assert(std::has_single_bit(Size) && Size >= 2 && Size <= 32768,
+                  "The size must be a power of two, up to 32kB");
+
+    using descriptor = typename Uart::descriptor;
+
+    static void start()
+    {
+        constexpr dma::transfer_config config{
+          .increment_read = false,
+          .request = Uart::rx_dreq,
+          .ring_bytes = Size,
+          .ring_on_write = true,
+        };
+        m_consumed = 0;
+        descriptor::uartdmacr::atomic_set_bits(
+          platform::uart::uartdmacr_bits::rxdmae);
+        dma::channel<Channel>::template start<config>(
+          descriptor::uartdr::addr,
+          dma::address_of(m_buffer.data()),
+          max_transfers);
+    }
+
+    // Number of bytes waiting in the ring (never more than Size)
+    static std::size_t available()
+    {
+        return std::min<std::size_t>(received() - m_consumed, Size);
+    }
+
+    // @return number of bytes copied
+    static std::size_t read_some(std::span<std::byte> data)
+    {
+        Uart::poll_errors();
+        const uint32_t total = received();
+        uint32_t pending = total - m_consumed;
+        if (pending > Size) {
+            m_dropped += pending - static_cast<uint32_t>(Size);
+            m_consumed = total - static_cast<uint32_t>(Size);
+            pending = Size;
+        }
+        const auto count = std::min<std::size_t>(pending, data.size());
+        const std::size_t start_at = m_consumed & (Size - 1);
+        const std::size_t first = std::min(count, Size - start_at);
+        std::copy_n(m_buffer.begin() + static_cast<std::ptrdiff_t>(start_at),
+                    first,
+                    data.begin());
+        std::copy_n(m_buffer.begin(),
+                    count - first,
+                    data.begin() + static_cast<std::ptrdiff_t>(first));
+        m_consumed += static_cast<uint32_t>(count);
+
+        // All 2^32 - 1 transfers done (~13 hours at 921600 baud)
+        if (total == max_transfers && m_consumed == total) {
+            start();
+        }
+        return count;
+    }
+
+    static uint32_t dropped()
+    {
+        return m_dropped;
+    }
+
+  private:
+    static constexpr platform::reg_val_t max_transfers = 0xffffffff;
+
+    static uint32_t received()
+    {
+        const uint32_t total =
+          max_transfers - dma::channel<Channel>::remaining();
+        // The data written by the DMA must not be read before the counter
+        std::atomic_signal_fence(std::memory_order_acquire);
+        return total;
+    }
+
+    alignas(Size) static inline std::array<std::byte, Size> m_buffer{};
+    static inline uint32_t m_consumed = 0;
+    static inline uint32_t m_dropped = 0;
+};
+
+// Interrupt-driven UART, data goes through statically sized rings:
+//
+//     using serial = uart::buffered<uart::uart0, 256, 64>;
+//     extern "C" void uart0_irq_isr() { serial::handle_interrupt(); }
+//
+// write() and read() never wait. Bytes which do not fit into the TX ring
+// (write) or into the RX ring (interrupt) are dropped and counted. With RTS
+// flow control (e.g. uart::uart0_rts_cts) nothing is dropped on the RX side:
+// the handler leaves the bytes in the FIFO and masks the RX interrupts while
+// the ring is full, the FIFO fills up and RTS stops the sender. read()
+// unmasks the interrupts again.
+//
+// The TX interrupt fires when the FIFO drains below the trigger level, it is
+// enabled only while the ring holds data. write() masks it while moving the
+// data to the FIFO itself - the handler and write() never consume the TX
+// ring at the same time.
+template<typename Uart, std::size_t TxSize, std::size_t RxSize>
+class buffered
+{
+  public:
+    using descriptor = typename Uart::descriptor;
+
+    /**
+     * Initialize UART and enable the RX (FIFO level and timeout) interrupts.
+     *
+     * @return the real configured baudrate, 0 if the UART did not come out of
+     * reset in time (the interrupts stay disabled)
+     */
+    static uint32_t init(uint32_t requested_baudrate,
+                         word_length data_bits = word_length::word_8_bits,
+                         stop_bits stop = stop_bits::one,
+                         parity parity_mode = parity::odd)
+    {
+        const auto real_baudrate =
+          Uart::init(requested_baudrate, data_bits, stop, parity_mode);
+        if (real_baudrate != 0) {
+            enable_rx_interrupts();
+        }
+        return real_baudrate;
+    }
+
+    // See uart<...>::init<Baudrate, TolerancePpm>()
+    template<uint32_t Baudrate,
+             uint32_t TolerancePpm = default_baudrate_tolerance_ppm>
+    static uint32_t init(word_length data_bits = word_length::word_8_bits,
+                         stop_bits stop = stop_bits::one,
+                         parity parity_mode = parity::odd)
+    {
+        const auto real_baudrate = Uart::template init<Baudrate, TolerancePpm>(
+          data_bits, stop, parity_mode);
+        if (real_baudrate != 0) {
+            enable_rx_interrupts();
+        }
+        return real_baudrate;
+    }
+
+    // @return number of bytes queued for transmission
+    static std::size_t write(std::span<const char> data)
+    {
+        const std::size_t queued = m_tx.push(data);
+        m_tx_dropped.store(m_tx_dropped.load(std::memory_order_relaxed) +
+                             static_cast<uint32_t>(data.size() - queued),
+                           std::memory_order_relaxed);
+        start_transmission();
+        return queued;
+    }
+
+    // @return number of bytes received
+    static std::size_t read(std::span<char> data)
+    {
+        const std::size_t count = m_rx.pop(data);
+        if (rts_enabled && count > 0) {
+            descriptor::uartimsc::atomic_set_bits(
+              platform::uart::uartimsc_bits::rxim,
+              platform::uart::uartimsc_bits::rtim);
+        }
+        return count;
+    }
+
+    // Number of bytes waiting in the RX ring
+    static std::size_t available()
+    {
+        return m_rx.size();
+    }
+
+    // Number of bytes dropped in both directions
+    static uint32_t dropped()
+    {
+        return m_tx_dropped.load(std::memory_order_relaxed) +
+               m_rx_dropped.load(std::memory_order_relaxed);
+    }
+
+    // To be called from the UART<n>_IRQ handler
+    static void handle_interrupt()
+    {
+        using namespace platform::uart;
+        const auto status = descriptor::uartmis::value();
+        if (status & bitmask(uartmis_bits::rxmis, uartmis_bits::rtmis)) {
+            // Reading the FIFO clears both interrupts
+            while (const std::size_t burst = Uart::rx_fill()) {
+                if (!receive(burst)) {
+                    break;
+                }
+            }
+        }
+        if (status & bit_value(uartmis_bits::txmis)) {
+            // At most tx_level entries are left in the FIFO
+            transmit(fifo_depth - fifo_entries(Uart::tx_level));
+            fill_fifo();
+            if (m_tx.empty()) {
+                descriptor::uartimsc::atomic_clear_bits(uartimsc_bits::txim);
+            }
+        }
+    }
+
+  private:
+    static constexpr bool rts_enabled = Uart::flow == flow_control::rts ||
+                                        Uart::flow == flow_control::rts_cts;
+
+    static void enable_rx_interrupts()
+    {
+        using platform::uart::uartimsc_bits;
+        descriptor::uartimsc::atomic_set_bits(uartimsc_bits::rxim,
+                                              uartimsc_bits::rtim);
+        irq::enable(Uart::uart_irq);
+    }
+
+    static void start_transmission()
+    {
+        using platform::uart::uartimsc_bits;
+        descriptor::uartimsc::atomic_clear_bits(uartimsc_bits::txim);
+        fill_fifo();
+        // The FIFO is full, the interrupt comes once it drains
+        if (!m_tx.empty()) {
+            descriptor::uartimsc::atomic_set_bits(uartimsc_bits::txim);
+        }
+    }
+
+    static void fill_fifo()
+    {
+        while (!m_tx.empty()) {
+            const std::size_t burst = Uart::tx_room();
+            if (burst == 0) {
+                return;
+            }
+            transmit(burst);
+        }
+    }
+
+    static void transmit(std::size_t count)
+    {
+        char data;
+        while (count-- > 0 && m_tx.pop(data)) {
+            descriptor::uartdr::set_value(static_cast<unsigned char>(data));
+        }
+    }
+
+    // @return false if the ring is full and the rest of the bytes stays in
+    // the FIFO (RTS flow control)
+    static bool receive(std::size_t count)
+    {
+        if constexpr (rts_enabled) {
+            const std::size_t room = RxSize - m_rx.size();
+            if (room < count) {
+                using platform::uart::uartimsc_bits;
+                descriptor::uartimsc::atomic_clear_bits(uartimsc_bits::rxim,
+                                                        uartimsc_bits::rtim);
+                for (std::size_t i = 0; i < room; ++i) {
+                    m_rx.push(static_cast<char>(Uart::read_fifo()));
+                }
+                return false;
+            }
+        }
+        uint32_t dropped = 0;
+        while (count-- > 0) {
+            const auto data = static_cast<char>(Uart::read_fifo());
+            dropped += m_rx.push(data) ? 0U : 1U;
+        }
+        if (dropped > 0) {
+            m_rx_dropped.store(
+              m_rx_dropped.load(std::memory_order_relaxed) + dropped,
+              std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    static inline ring::spsc<char, TxSize> m_tx;
+    static inline ring::spsc<char, RxSize> m_rx;
+    // Each counter is stored by one side only (no read-modify-write atomics
+    // on the Cortex-M0+)
+    static inline std::atomic<uint32_t> m_tx_dropped = 0;
+    static inline std::atomic<uint32_t> m_rx_dropped = 0;
+};
+
 constexpr uart0 uart0_tag [[maybe_unused]] = uart0{};
 constexpr uart1 uart1_tag [[maybe_unused]] = uart1{};
 
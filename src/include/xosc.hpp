@@ -22,6 +22,7 @@
 #ifndef XOSC_HPP
 #define XOSC_HPP
 
+#include "busy_wait.hpp"
 #include "rp2040.hpp"
 
 class xosc
@@ -33,7 +34,7 @@ class xosc
     static constexpr uint32_t xosc_freq = platform::xosc::frequency_khz;
     static constexpr uint32_t startup_delay = (((xosc_freq + 128) / 256) * 64);
 
-    static constexpr void init()
+    [[nodiscard]] static busy_wait::result init()
     {
         using namespace platform::xosc;
 
@@ -41,18 +42,19 @@ class xosc
         startup::update_regions(startup_region_delay{startup_delay});
         ctrl::update_regions(regions::ctrl::enable::enable);
 
-        while (!status::get_bit(status_bits::stable)) {
-            // wait for xosc to become stable
-        }
+        return busy_wait::until(busy_wait::sites::xosc_stable, [] {
+            return status::get_bit(status_bits::stable);
+        });
     }
 
-    static constexpr void disable()
+    [[nodiscard]] static busy_wait::result disable()
     {
         using namespace platform::xosc;
         ctrl::update_regions(regions::ctrl::enable::disable);
-        while (status::get_bit(status_bits::stable)) {
-            // wait for clock to become unstable (stable flag needs to go away)
-        }
+        // wait for clock to become unstable (stable flag needs to go away)
+        return busy_wait::until(busy_wait::sites::xosc_disabled, [] {
+            return !status::get_bit(status_bits::stable);
+        });
     }
 };
 
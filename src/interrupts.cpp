@@ -32,7 +32,12 @@ using interrupt_handler_t = std::uintptr_t;
 extern "C" void default_isr()
 {
     using namespace platform;
-    reset::release_subsystem_wait(reset::subsystems::io_bank0);
+    if (reset::release_subsystem_wait(reset::subsystems::io_bank0) !=
+        busy_wait::result::ready) {
+        // No GPIO to signal the error with
+        while (true) {
+        }
+    }
     gpio::pin<pins::gpio25> led0;
     led0.function_select(gpio::functions::sio);
     led0.set_as_output();
@@ -73,6 +78,35 @@ extern "C" void hardfault_isr()
     }
 }
 
+// Peripheral interrupts (platform::irqs), override by defining a function
+// with the same name
+extern "C" void timer_irq_0_isr() __attribute__((weak, alias("default_isr")));
+extern "C" void timer_irq_1_isr() __attribute__((weak, alias("default_isr")));
+extern "C" void timer_irq_2_isr() __attribute__((weak, alias("default_isr")));
+extern "C" void timer_irq_3_isr() __attribute__((weak, alias("default_isr")));
+extern "C" void pwm_irq_wrap_isr() __attribute__((weak, alias("default_isr")));
+extern "C" void usbctrl_irq_isr() __attribute__((weak, alias("default_isr")));
+extern "C" void xip_irq_isr() __attribute__((weak, alias("default_isr")));
+extern "C" void pio0_irq_0_isr() __attribute__((weak, alias("default_isr")));
+extern "C" void pio0_irq_1_isr() __attribute__((weak, alias("default_isr")));
+extern "C" void pio1_irq_0_isr() __attribute__((weak, alias("default_isr")));
+extern "C" void pio1_irq_1_isr() __attribute__((weak, alias("default_isr")));
+extern "C" void dma_irq_0_isr() __attribute__((weak, alias("default_isr")));
+extern "C" void dma_irq_1_isr() __attribute__((weak, alias("default_isr")));
+extern "C" void io_irq_bank0_isr() __attribute__((weak, alias("default_isr")));
+extern "C" void io_irq_qspi_isr() __attribute__((weak, alias("default_isr")));
+extern "C" void sio_irq_proc0_isr() __attribute__((weak, alias("default_isr")));
+extern "C" void sio_irq_proc1_isr() __attribute__((weak, alias("default_isr")));
+extern "C" void clocks_irq_isr() __attribute__((weak, alias("default_isr")));
+extern "C" void spi0_irq_isr() __attribute__((weak, alias("default_isr")));
+extern "C" void spi1_irq_isr() __attribute__((weak, alias("default_isr")));
+extern "C" void uart0_irq_isr() __attribute__((weak, alias("default_isr")));
+extern "C" void uart1_irq_isr() __attribute__((weak, alias("default_isr")));
+extern "C" void adc_irq_fifo_isr() __attribute__((weak, alias("default_isr")));
+extern "C" void i2c0_irq_isr() __attribute__((weak, alias("default_isr")));
+extern "C" void i2c1_irq_isr() __attribute__((weak, alias("default_isr")));
+extern "C" void rtc_irq_isr() __attribute__((weak, alias("default_isr")));
+
 constexpr interrupt_handler_t irq_t(const auto ptr)
 {
     return reinterpret_cast<interrupt_handler_t>(ptr);
@@ -91,32 +125,32 @@ struct __attribute__((packed)) vector_table
     uint32_t invalid1[2] = {};
     interrupt_handler_t isr_pendsv = irq_t(pendsv_isr);
     interrupt_handler_t isr_systick = irq_t(systick_isr);
-    interrupt_handler_t isr_irq0 = irq_t(default_isr);
-    interrupt_handler_t isr_irq1 = irq_t(default_isr);
-    interrupt_handler_t isr_irq2 = irq_t(default_isr);
-    interrupt_handler_t isr_irq3 = irq_t(default_isr);
-    interrupt_handler_t isr_irq4 = irq_t(default_isr);
-    interrupt_handler_t isr_irq5 = irq_t(default_isr);
-    interrupt_handler_t isr_irq6 = irq_t(default_isr);
-    interrupt_handler_t isr_irq7 = irq_t(default_isr);
-    interrupt_handler_t isr_irq8 = irq_t(default_isr);
-    interrupt_handler_t isr_irq9 = irq_t(default_isr);
-    interrupt_handler_t isr_irq10 = irq_t(default_isr);
-    interrupt_handler_t isr_irq11 = irq_t(default_isr);
-    interrupt_handler_t isr_irq12 = irq_t(default_isr);
-    interrupt_handler_t isr_irq13 = irq_t(default_isr);
-    interrupt_handler_t isr_irq14 = irq_t(default_isr);
-    interrupt_handler_t isr_irq15 = irq_t(default_isr);
-    interrupt_handler_t isr_irq16 = irq_t(default_isr);
-    interrupt_handler_t isr_irq17 = irq_t(default_isr);
-    interrupt_handler_t isr_irq18 = irq_t(default_isr);
-    interrupt_handler_t isr_irq19 = irq_t(default_isr);
-    interrupt_handler_t isr_irq20 = irq_t(default_isr);
-    interrupt_handler_t isr_irq21 = irq_t(default_isr);
-    interrupt_handler_t isr_irq22 = irq_t(default_isr);
-    interrupt_handler_t isr_irq23 = irq_t(default_isr);
-    interrupt_handler_t isr_irq24 = irq_t(default_isr);
-    interrupt_handler_t isr_irq25 = irq_t(default_isr);
+    interrupt_handler_t isr_irq0 = irq_t(timer_irq_0_isr);
+    interrupt_handler_t isr_irq1 = irq_t(timer_irq_1_isr);
+    interrupt_handler_t isr_irq2 = irq_t(timer_irq_2_isr);
+    interrupt_handler_t isr_irq3 = irq_t(timer_irq_3_isr);
+    interrupt_handler_t isr_irq4 = irq_t(pwm_irq_wrap_isr);
+    interrupt_handler_t isr_irq5 = irq_t(usbctrl_irq_isr);
+    interrupt_handler_t isr_irq6 = irq_t(xip_irq_isr);
+    interrupt_handler_t isr_irq7 = irq_t(pio0_irq_0_isr);
+    interrupt_handler_t isr_irq8 = irq_t(pio0_irq_1_isr);
+    interrupt_handler_t isr_irq9 = irq_t(pio1_irq_0_isr);
+    interrupt_handler_t isr_irq10 = irq_t(pio1_irq_1_isr);
+    interrupt_handler_t isr_irq11 = irq_t(dma_irq_0_isr);
+    interrupt_handler_t isr_irq12 = irq_t(dma_irq_1_isr);
+    interrupt_handler_t isr_irq13 = irq_t(io_irq_bank0_isr);
+    interrupt_handler_t isr_irq14 = irq_t(io_irq_qspi_isr);
+    interrupt_handler_t isr_irq15 = irq_t(sio_irq_proc0_isr);
+    interrupt_handler_t isr_irq16 = irq_t(sio_irq_proc1_isr);
+    interrupt_handler_t isr_irq17 = irq_t(clocks_irq_isr);
+    interrupt_handler_t isr_irq18 = irq_t(spi0_irq_isr);
+    interrupt_handler_t isr_irq19 = irq_t(spi1_irq_isr);
+    interrupt_handler_t isr_irq20 = irq_t(uart0_irq_isr);
+    interrupt_handler_t isr_irq21 = irq_t(uart1_irq_isr);
+    interrupt_handler_t isr_irq22 = irq_t(adc_irq_fifo_isr);
+    interrupt_handler_t isr_irq23 = irq_t(i2c0_irq_isr);
+    interrupt_handler_t isr_irq24 = irq_t(i2c1_irq_isr);
+    interrupt_handler_t isr_irq25 = irq_t(rtc_irq_isr);
     interrupt_handler_t isr_irq26 = irq_t(default_isr);
     interrupt_handler_t isr_irq27 = irq_t(default_isr);
     interrupt_handler_t isr_irq28 = irq_t(default_isr);
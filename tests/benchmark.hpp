@@ -0,0 +1,65 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string_view>
+
+#include "hwio_simulator.hpp"
+
+// Microbenchmarks of the drivers running on top of the simulated register
+// file. The host timings are only useful to compare implementations, the
+// number of register accesses per operation is what matters on the target.
+namespace benchmark {
+
+template<typename Body>
+void run(std::string_view name, std::size_t iterations, Body body)
+{
+    auto& registers = hwio::simulator::registers();
+    registers.reset_statistics();
+
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+        body();
+    }
+    const auto stop = std::chrono::steady_clock::now();
+
+    const auto elapsed =
+      std::chrono::duration<double, std::nano>(stop - start).count();
+    const auto per_op = [iterations](std::size_t count) {
+        return static_cast<double>(count) / static_cast<double>(iterations);
+    };
+
+    std::cout << std::left << std::setw(40) << name << std::right
+              << std::fixed << std::setprecision(1) << std::setw(10)
+              << elapsed / static_cast<double>(iterations) << " ns/op"
+              << std::setw(8) << per_op(registers.total_reads()) << " R/op"
+              << std::setw(8) << per_op(registers.total_writes()) << " W/op\n";
+}
+
+}
+
+#endif
@@ -0,0 +1,76 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cstddef>
+
+#include "benchmark.hpp"
+#include "pwm.hpp"
+#include "rp2040_simulator.hpp"
+#include "uart.hpp"
+
+int main()
+{
+    using namespace platform::uart;
+    using uart_registers = platform::uart::uart0;
+    constexpr std::size_t iterations = 100'000;
+
+    rp2040_simulator::setup();
+    // The transmitter is idle, the TX FIFO is always empty
+    hwio::simulator::registers().poke(uart_registers::uartfr::addr,
+                                      bit_value(uartfr_bits::txfe));
+
+    benchmark::run("uart0::init", iterations, [] {
+        uart::uart0::init(115200);
+    });
+
+    benchmark::run("uart0::set_format", iterations, [] {
+        uart::uart0::set_format(uart::word_length::word_8_bits,
+                                uart::stop_bits::one,
+                                uart::parity::even);
+    });
+
+    benchmark::run("uart0::puts (16 characters)", iterations, [] {
+        uart::uart0::puts("0123456789abcdef");
+    });
+
+    benchmark::run("uartlcr_h::update_regions", iterations, [] {
+        uart_registers::uartlcr_h::update_regions(
+          uartlcr_h_region_wlen{uartlcr_h_region_wlen_values::word_7_bits},
+          uartlcr_h_region_parity{uartlcr_h_region_parity_values::odd});
+    });
+
+    benchmark::run("uartlcr_h::atomic_update_regions", iterations, [] {
+        uart_registers::uartlcr_h::atomic_update_regions(
+          uartlcr_h_region_wlen{uartlcr_h_region_wlen_values::word_7_bits},
+          uartlcr_h_region_parity{uartlcr_h_region_parity_values::odd});
+    });
+
+    benchmark::run("pwm::slice0 enable + disable", iterations, [] {
+        pwm::slice0::enable();
+        pwm::slice0::disable();
+    });
+
+    benchmark::run("pwm::slice0::set_frequency", iterations, [] {
+        pwm::slice0::set_frequency(1000);
+    });
+
+    return 0;
+}
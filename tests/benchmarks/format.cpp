@@ -0,0 +1,95 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "benchmark.hpp"
+#include "format.hpp"
+#include "rp2040_simulator.hpp"
+#include "uart.hpp"
+
+namespace {
+
+// The usual hand-written conversion (a division by 10 per digit)
+void print_number(int32_t value)
+{
+    std::array<char, 12> digits;
+    std::size_t position = digits.size();
+    auto magnitude = static_cast<uint32_t>(value);
+    if (value < 0) {
+        magnitude = 0U - magnitude;
+    }
+    do {
+        digits[--position] = static_cast<char>('0' + (magnitude % 10));
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0) {
+        digits[--position] = '-';
+    }
+    uart::uart0::puts({digits.data() + position, digits.size() - position});
+}
+
+}
+
+int main()
+{
+    constexpr std::size_t iterations = 100'000;
+
+    rp2040_simulator::setup();
+    // The transmitter is idle, the TX FIFO is always empty
+    hwio::simulator::registers().poke(
+      platform::uart::uart0::uartfr::addr,
+      bit_value(platform::uart::uartfr_bits::txfe));
+
+    static volatile int32_t first = -1234567;
+    static volatile int32_t second = 42;
+
+    benchmark::run("itoa + uart0::puts (two numbers)", iterations, [] {
+        print_number(first);
+        uart::uart0::puts(" ");
+        print_number(second);
+        uart::uart0::puts("\r\n");
+    });
+
+    benchmark::run("format::print (two numbers)", iterations, [] {
+        format::print(uart::uart0_tag, "{} {}\r\n", first, second);
+    });
+
+    benchmark::run("format::print (fixed point, hex)", iterations, [] {
+        format::print(uart::uart0_tag,
+                      "{} {:08x}\r\n",
+                      format::fixed<2>{first},
+                      static_cast<uint32_t>(second));
+    });
+
+    std::array<char, 32> buffer;
+    benchmark::run("format::format_to (two numbers)", iterations, [&] {
+        [[maybe_unused]] volatile std::size_t size =
+          format::format_to(buffer, "{} {}", first, second);
+    });
+
+    return 0;
+}
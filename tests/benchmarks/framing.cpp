@@ -0,0 +1,102 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <span>
+
+#include "benchmark.hpp"
+#include "framing.hpp"
+#include "rp2040_simulator.hpp"
+#include "uart.hpp"
+
+namespace {
+
+namespace sim = hwio::simulator;
+
+// TX looped back to RX through an unbounded FIFO
+std::deque<sim::value_t> loopback;
+
+void install_loopback()
+{
+    using namespace platform::uart;
+    auto& registers = sim::registers();
+    registers.on_read(uart0::uartfr::addr, [](sim::address_t, sim::value_t) {
+        return bitmask(uartfr_bits::txfe) |
+               (loopback.empty() ? bitmask(uartfr_bits::rxfe) : 0) |
+               (loopback.size() >= 32 ? bitmask(uartfr_bits::rxff) : 0);
+    });
+    registers.on_write(uart0::uartdr::addr,
+                       [](sim::address_t, sim::value_t value) {
+                           loopback.push_back(value);
+                       });
+    registers.on_read(uart0::uartdr::addr, [](sim::address_t, sim::value_t) {
+        const auto value = loopback.front();
+        loopback.pop_front();
+        return value;
+    });
+}
+
+}
+
+int main()
+{
+    constexpr std::size_t iterations = 100'000;
+
+    rp2040_simulator::setup();
+    install_loopback();
+
+    static std::array<std::byte, 64> payload{};
+    for (std::size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = static_cast<std::byte>(i * 37);
+    }
+    const std::array parts{std::span<const std::byte>{payload}};
+    std::array<std::byte, framing::max_frame_size(payload.size())> frame{};
+
+    benchmark::run("framing::crc16 (64 bytes)", iterations, [] {
+        [[maybe_unused]] volatile auto crc = framing::crc16::compute(payload);
+    });
+
+    benchmark::run("framing::crc32 (64 bytes)", iterations, [] {
+        [[maybe_unused]] volatile auto crc = framing::crc32::compute(payload);
+    });
+
+    benchmark::run("framing::encode_frame (64 bytes)", iterations, [&] {
+        [[maybe_unused]] volatile auto size =
+          framing::encode_frame(parts, frame);
+    });
+
+    static framing::receiver<framing::crc16, 256> link;
+    benchmark::run("uart0 loopback: send + receive frame", iterations, [&] {
+        framing::send_frame(uart::uart0_tag, parts);
+        while (link.receive<uart::uart0>() != 0) {
+        }
+        std::span<const std::byte> received;
+        while (link.next(received)) {
+        }
+    });
+
+    return link.stats().frames == iterations ? 0 : 1;
+}
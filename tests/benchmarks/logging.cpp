@@ -0,0 +1,56 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#include <cstddef>
+#include <cstdint>
+
+#include "benchmark.hpp"
+#include "format.hpp"
+#include "logging.hpp"
+#include "rp2040_simulator.hpp"
+#include "uart.hpp"
+
+int main()
+{
+    constexpr std::size_t iterations = 100'000;
+
+    rp2040_simulator::setup();
+    // The transmitter is idle, the TX FIFO is always empty
+    hwio::simulator::registers().poke(
+      platform::uart::uart0::uartfr::addr,
+      bit_value(platform::uart::uartfr_bits::txfe));
+
+    static volatile int32_t first = -1234567;
+    static volatile int32_t second = 42;
+
+    benchmark::run("format::print (two numbers)", iterations, [] {
+        format::print(uart::uart0_tag, "{} {}\r\n", first, second);
+    });
+
+    benchmark::run("logging::info + drain (two numbers)", iterations, [] {
+        logging::info<"{} {}">(first, second);
+        logging::drain(uart::uart0_tag);
+    });
+
+    return 0;
+}
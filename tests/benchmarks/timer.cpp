@@ -0,0 +1,61 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <cstddef>
+#include <cstdint>
+
+#include "benchmark.hpp"
+#include "rp2040_simulator.hpp"
+#include "timer.hpp"
+
+int main()
+{
+    using namespace std::chrono_literals;
+    constexpr std::size_t iterations = 100'000;
+
+    rp2040_simulator::setup();
+
+    benchmark::run("timer::clock::now", iterations, [] {
+        [[maybe_unused]] volatile auto now = timer::clock::now();
+    });
+
+    benchmark::run("timer::clock::now_latched", iterations, [] {
+        [[maybe_unused]] volatile auto now = timer::clock::now_latched();
+    });
+
+    benchmark::run("timer::clock::now_lo", iterations, [] {
+        [[maybe_unused]] volatile uint32_t now = timer::clock::now_lo();
+    });
+
+    const auto deadline = timer::clock::now() + 1h;
+    benchmark::run("64-bit deadline check", iterations, [deadline] {
+        [[maybe_unused]] volatile bool expired =
+          timer::clock::now() >= deadline;
+    });
+
+    const auto short_deadline = timer::short_deadline::after(1h);
+    benchmark::run("timer::short_deadline::has_expired", iterations, [&] {
+        [[maybe_unused]] volatile bool expired = short_deadline.has_expired();
+    });
+
+    return 0;
+}
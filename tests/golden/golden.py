@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+#
+# Author: Patryk Jaworski <regalis@regalis.tech>
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+
+"""Instruction-level golden tests.
+
+Disassembles the given object files (or static libraries) and compares every
+golden_* function with the listing checked in to the golden file.
+
+The test fails if a function:
+  * has more instructions than the golden listing,
+  * performs more loads (other than PC-relative literal loads) than the
+    golden listing,
+  * has no golden listing (or the listed function is not found),
+  * belongs to a golden file without any listing.
+
+Any other difference (e.g. different register allocation) is reported, but
+does not fail the test. Use --update to regenerate the golden listing.
+"""
+
+import argparse
+import difflib
+import re
+import subprocess
+import sys
+
+FUNCTION_PREFIX = 'golden_'
+FUNCTION = re.compile(r'^[0-9a-f]+ <(?P<name>[^>]+)>:$')
+INSTRUCTION = re.compile(
+    r'^\s+[0-9a-f]+:\s+(?P<mnemonic>\S+)\s*(?P<operands>.*)$')
+DATA_DIRECTIVES = ('.word', '.short', '.byte')
+LOAD = re.compile(r'^(ldr|ldm)')
+LITERAL_LOAD = re.compile(r'\[pc(, #-?\d+)?\]')
+PADDING = ('nop', 'mov\tr8, r8')
+
+
+def normalize(mnemonic, operands):
+    operands = re.split(r'\s+[@;]', operands)[0].strip()
+    operands = LITERAL_LOAD.sub('[pc, #literal]', operands)
+    operands = operands.replace(', #0]', ']')
+    # Branch targets: drop the absolute address, keep the symbolic one
+    operands = re.sub(r'^(0x)?[0-9a-f]+ (<[^>]+>)$', r'\2', operands)
+    return f'{mnemonic}\t{operands}'.rstrip()
+
+
+def strip_padding(listing):
+    """Drop the alignment of the literal pool (never executed)."""
+    while listing and listing[-1] in PADDING:
+        listing.pop()
+    return listing
+
+
+def disassemble(objdump, objects):
+    output = subprocess.run([objdump, '-d', '--no-show-raw-insn', *objects],
+                            check=True, capture_output=True, text=True).stdout
+    functions, current = {}, None
+    for line in output.splitlines():
+        if match := FUNCTION.match(line):
+            name = match.group('name')
+            current = functions.setdefault(name, []) \
+                if name.startswith(FUNCTION_PREFIX) else None
+        elif current is not None and (match := INSTRUCTION.match(line)):
+            if match.group('mnemonic') not in DATA_DIRECTIVES:
+                current.append(normalize(match.group('mnemonic'),
+                                         match.group('operands')))
+        elif not line.strip():
+            current = None
+    return {name: strip_padding(listing)
+            for name, listing in functions.items()}
+
+
+def read_golden(path):
+    header, functions, current = [], {}, None
+    with open(path) as golden:
+        for line in golden:
+            line = line.rstrip()
+            if line.startswith('#') and not functions:
+                header.append(line)
+            elif not line or line.startswith('#'):
+                continue
+            elif not line[0].isspace() and line.endswith(':'):
+                current = functions.setdefault(line[:-1], [])
+            elif current is not None:
+                mnemonic, _, operands = line.strip().partition('\t')
+                current.append(normalize(mnemonic, operands))
+    return header, functions
+
+
+def write_golden(path, header, functions):
+    with open(path, 'w') as golden:
+        golden.write('\n'.join(header) + '\n')
+        for name in sorted(functions):
+            golden.write(f'\n{name}:\n')
+            golden.writelines(f'\t{line}\n' for line in functions[name])
+
+
+def loads(listing):
+    return sum(1 for line in listing
+               if LOAD.match(line) and '[pc, #literal]' not in line)
+
+
+def compare(name, expected, actual):
+    failures = []
+    if len(actual) > len(expected):
+        failures.append(f'{len(actual)} instructions, '
+                        f'budget: {len(expected)}')
+    if loads(actual) > loads(expected):
+        failures.append(f'{loads(actual)} loads, budget: {loads(expected)}')
+
+    status = 'FAIL' if failures else ' OK '
+    print(f'[{status}] {name}: {len(actual)}/{len(expected)} instructions, '
+          f'{loads(actual)}/{loads(expected)} loads')
+    for failure in failures:
+        print(f'       {failure}')
+    if actual != expected:
+        sys.stdout.writelines(
+            f'       {line}\n' for line in difflib.unified_diff(
+                expected, actual, 'golden', 'actual', lineterm=''))
+    return not failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--objdump', default='arm-none-eabi-objdump')
+    parser.add_argument('--update', action='store_true',
+                        help='regenerate the golden listing')
+    parser.add_argument('golden', help='golden listing')
+    parser.add_argument('objects', nargs='+',
+                        help='object files or static libraries')
+    args = parser.parse_args()
+
+    actual = disassemble(args.objdump, args.objects)
+    header, expected = read_golden(args.golden)
+
+    if args.update:
+        write_golden(args.golden, header, actual)
+        return 0
+
+    if not expected:
+        print(f'[FAIL] {args.golden}: no golden listings recorded '
+              '(use --update)')
+        return 1
+
+    passed = True
+    for name in sorted(expected.keys() | actual.keys()):
+        if name not in actual:
+            print(f'[FAIL] {name}: function not found')
+            passed = False
+        elif name not in expected:
+            print(f'[FAIL] {name}: no golden listing (use --update)')
+            passed = False
+        else:
+            passed = compare(name, expected[name], actual[name]) and passed
+    return 0 if passed else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
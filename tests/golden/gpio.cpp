@@ -0,0 +1,79 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "gpio.hpp"
+#include "gpio_interrupts.hpp"
+
+extern "C"
+{
+    void gpio_rising_edge_handler(platform::reg_val_t events);
+    void gpio_falling_edge_handler(platform::reg_val_t events);
+    void golden_gpio_pin_toggle()
+    {
+        gpio::pin<platform::pins::gpio25>::toggle();
+    }
+
+    void golden_gpio_set_high_multiple_pins()
+    {
+        gpio::set_high(gpio::pin<platform::pins::gpio0>{},
+                       gpio::pin<platform::pins::gpio1>{},
+                       gpio::pin<platform::pins::gpio7>{});
+    }
+
+    void golden_gpio_function_select()
+    {
+        gpio::pin<platform::pins::gpio25>::function_select(
+          gpio::functions::sio);
+    }
+
+    void golden_gpio_bus_write_contiguous(platform::reg_val_t value)
+    {
+        gpio::bus<platform::pins::gpio18,
+                  platform::pins::gpio19,
+                  platform::pins::gpio20,
+                  platform::pins::gpio21>::write(value);
+    }
+
+    void golden_gpio_bus_write_scattered(platform::reg_val_t value)
+    {
+        gpio::bus<platform::pins::gpio2,
+                  platform::pins::gpio5,
+                  platform::pins::gpio9,
+                  platform::pins::gpio11>::write(value);
+    }
+
+    void golden_gpio_input_scanner_update(gpio::input_scanner& scanner,
+                                          platform::reg_val_t sample)
+    {
+        scanner.update(sample);
+    }
+
+    void golden_gpio_interrupt_dispatch()
+    {
+        gpio::interrupt_dispatcher<
+          gpio::interrupt_handler<gpio::pin<platform::pins::gpio2>,
+                                  gpio_rising_edge_handler,
+                                  gpio::irq_events::edge_high>,
+          gpio::interrupt_handler<gpio::pin<platform::pins::gpio5>,
+                                  gpio_falling_edge_handler,
+                                  gpio::irq_events::edge_low>>::dispatch();
+    }
+}
@@ -0,0 +1,80 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <utility>
+
+#include "block_store.hpp"
+#include "hwio.hpp"
+#include "pads.hpp"
+#include "rp2040.hpp"
+
+extern "C"
+{
+    void golden_hwio_set_value(platform::reg_val_t value)
+    {
+        platform::uart::uart0::uartibrd::set_value(value);
+    }
+
+    void golden_hwio_update_regions()
+    {
+        using namespace platform::uart;
+        uart0::uartlcr_h::update_regions(
+          uartlcr_h_region_wlen{uartlcr_h_region_wlen_values::word_7_bits},
+          uartlcr_h_region_parity{uartlcr_h_region_parity_values::even});
+    }
+
+    platform::reg_val_t golden_hwio_read_regions()
+    {
+        using namespace platform::uart;
+        const auto [wlen, parity] =
+          uart0::uartlcr_h::read_regions<uartlcr_h_region_wlen,
+                                         uartlcr_h_region_parity>();
+        return std::to_underlying(wlen) + std::to_underlying(parity);
+    }
+
+    void golden_hwio_atomic_set_bits()
+    {
+        platform::uart::uart0::uartcr::atomic_set_bits(
+          platform::uart::uartcr_bits::uarten);
+    }
+
+    void golden_hwio_transaction(platform::reg_val_t ibrd,
+                                 platform::reg_val_t fbrd)
+    {
+        using namespace platform::uart;
+        hwio::transaction{
+          hwio::op::set_value<uart0::uartibrd>(ibrd),
+          hwio::op::set_value<uart0::uartfbrd>(fbrd),
+          hwio::ordered,
+          hwio::op::update_regions<uart0::uartlcr_h>(
+            uartlcr_h_region_wlen{uartlcr_h_region_wlen_values::word_8_bits}),
+          hwio::op::set_bits<uart0::uartlcr_h>(uartlcr_h_bits::fen)}
+          .commit();
+    }
+
+    void golden_hwio_block_store_same(platform::reg_val_t value)
+    {
+        hwio::block_store<pads::qspi_sd0::pad_reg,
+                          pads::qspi_sd1::pad_reg,
+                          pads::qspi_sd2::pad_reg,
+                          pads::qspi_sd3::pad_reg>::store_same(value);
+    }
+}
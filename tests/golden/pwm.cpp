@@ -0,0 +1,43 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cstdint>
+
+#include "pwm.hpp"
+
+extern "C"
+{
+    void golden_pwm_set_channel_levels(uint16_t level_a, uint16_t level_b)
+    {
+        pwm::slice0::set_channel_levels(pwm::channel_a{level_a},
+                                        pwm::channel_b{level_b});
+    }
+
+    void golden_pwm_set_channel_level(uint16_t level)
+    {
+        pwm::slice0::set_channel_levels(pwm::channel_b{level});
+    }
+
+    void golden_pwm_enable()
+    {
+        pwm::slice0::enable();
+    }
+}
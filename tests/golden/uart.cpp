@@ -0,0 +1,42 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "uart.hpp"
+
+extern "C"
+{
+    void golden_uart_putc(char character)
+    {
+        uart::uart0::putc(character);
+    }
+
+    char golden_uart_getc()
+    {
+        return uart::uart0::getc();
+    }
+
+    void golden_uart_set_format()
+    {
+        uart::uart0::set_format(uart::word_length::word_8_bits,
+                                uart::stop_bits::one,
+                                uart::parity::even);
+    }
+}
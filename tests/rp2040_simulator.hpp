@@ -0,0 +1,186 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RP2040_SIMULATOR_HPP
+#define RP2040_SIMULATOR_HPP
+
+#include <cstdint>
+
+#include "hwio_simulator.hpp"
+#include "rp2040.hpp"
+
+// Models the bits of the RP2040 behaviour the drivers depend on, on top of
+// the simulated register file.
+namespace rp2040_simulator {
+
+namespace sim = hwio::simulator;
+
+// Simulated time in microseconds (TIMER), advanced on every read of TIMERAWL
+inline uint64_t time_us = 0;
+
+// SysTick: advances by this many cycles on every read of SYST_CVR
+constexpr sim::value_t systick_cycles_per_read = 10;
+
+// TIMER INTR (raw interrupts, write 1 to clear)
+inline sim::value_t timer_intr = 0;
+
+inline sim::decoded_address decode_atomic_alias(sim::address_t addr)
+{
+    using sim::write_operation;
+    if (!platform::supports_atomic_aliases(
+          static_cast<platform::reg_ptr_t>(addr))) {
+        return {addr};
+    }
+    constexpr sim::address_t alias_bits = 0x3000;
+    const sim::address_t target = addr & ~alias_bits;
+    switch ((addr & alias_bits) >> 12) {
+        case 1:
+            return {target, write_operation::bitwise_xor};
+        case 2:
+            return {target, write_operation::bitwise_set};
+        case 3:
+            return {target, write_operation::bitwise_clear};
+        default:
+            return {target};
+    }
+}
+
+// WFE/WFI: the time jumps to the nearest enabled alarm, which fires
+inline void wait_for_alarm()
+{
+    using namespace platform::timer;
+    auto& registers = sim::registers();
+    const sim::value_t enabled = registers.peek(inte::addr);
+    for (platform::reg_val_t index = 0; index < 4; ++index) {
+        if ((enabled & (1U << index)) == 0) {
+            continue;
+        }
+        const auto target = static_cast<uint32_t>(
+          registers.peek(platform::timer::alarm<0>::addr + (index * 4)));
+        const auto ahead = target - static_cast<uint32_t>(time_us);
+        if (ahead < (1U << 31)) {
+            time_us += ahead;
+            timer_intr |= 1U << index;
+            registers.poke(intr::addr, timer_intr);
+            return;
+        }
+    }
+}
+
+template<typename Uart>
+void clear_on_write()
+{
+    sim::registers().on_write(
+      Uart::uarticr::addr, [](sim::address_t addr, sim::value_t value) {
+          sim::registers().poke(Uart::uartris::addr,
+                                sim::registers().peek(Uart::uartris::addr) &
+                                  ~value);
+          sim::registers().poke(addr, 0);
+      });
+}
+
+// Reset the register file and install the RP2040 models
+inline void setup()
+{
+    auto& registers = sim::registers();
+    registers.reset();
+    registers.set_alias_decoder(decode_atomic_alias);
+    sim::core::interrupts_enabled = true;
+    sim::core::on_wait = wait_for_alarm;
+    sim::core::delayed_cycles = 0;
+
+    // RESETS: a subsystem is done as soon as it is released from reset
+    constexpr sim::value_t all_subsystems = 0x1ffffff;
+    registers.poke(platform::registers::reset::addr, all_subsystems);
+    registers.on_write(
+      platform::registers::reset::addr, [](sim::address_t, sim::value_t value) {
+          sim::registers().poke(platform::registers::reset_done::addr,
+                                ~value & all_subsystems);
+      });
+
+    // SIO: GPIO_OUT_SET/CLR/XOR modify GPIO_OUT
+    using namespace platform::registers;
+    registers.on_write(
+      gpio_out_set::addr, [](sim::address_t addr, sim::value_t value) {
+          sim::registers().poke(gpio_out::addr,
+                                sim::registers().peek(gpio_out::addr) | value);
+          sim::registers().poke(addr, 0);
+      });
+    registers.on_write(
+      gpio_out_clr::addr, [](sim::address_t addr, sim::value_t value) {
+          sim::registers().poke(gpio_out::addr,
+                                sim::registers().peek(gpio_out::addr) & ~value);
+          sim::registers().poke(addr, 0);
+      });
+    registers.on_write(
+      gpio_out_xor::addr, [](sim::address_t addr, sim::value_t value) {
+          sim::registers().poke(gpio_out::addr,
+                                sim::registers().peek(gpio_out::addr) ^ value);
+          sim::registers().poke(addr, 0);
+      });
+
+    // DMA: an aborted channel stops at once
+    registers.on_write(platform::dma::chan_abort::addr,
+                       [](sim::address_t addr, sim::value_t) {
+                           sim::registers().poke(addr, 0);
+                       });
+
+    // UART: UARTICR clears the raw interrupt status (write one to clear)
+    clear_on_write<platform::uart::uart0>();
+    clear_on_write<platform::uart::uart1>();
+
+    // TIMER: 1MHz free running counter
+    time_us = 0;
+    registers.on_read(platform::timer::timerawl::addr,
+                      [](sim::address_t, sim::value_t) -> sim::value_t {
+                          return (time_us++) & 0xffffffff;
+                      });
+    registers.on_read(platform::timer::timerawh::addr,
+                      [](sim::address_t, sim::value_t) -> sim::value_t {
+                          return time_us >> 32;
+                      });
+    // TIMELR latches TIMEHR
+    registers.on_read(platform::timer::timelr::addr,
+                      [](sim::address_t, sim::value_t) -> sim::value_t {
+                          sim::registers().poke(platform::timer::timehr::addr,
+                                                time_us >> 32);
+                          return (time_us++) & 0xffffffff;
+                      });
+    timer_intr = 0;
+    registers.on_write(platform::timer::intr::addr,
+                       [](sim::address_t addr, sim::value_t value) {
+                           timer_intr &= ~value;
+                           sim::registers().poke(addr, timer_intr);
+                       });
+
+    // SysTick: 24-bit down counter
+    registers.on_read(platform::m0plus::syst_cvr::addr,
+                      [](sim::address_t addr, sim::value_t current) {
+                          const sim::value_t next =
+                            (current - systick_cycles_per_read) & 0xffffff;
+                          sim::registers().poke(addr, next);
+                          return next;
+                      });
+}
+
+}
+
+#endif
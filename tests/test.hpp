@@ -0,0 +1,114 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TEST_HPP
+#define TEST_HPP
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <source_location>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+// Minimalistic unit test framework for the host build (no dependencies, no
+// preprocessor macros).
+namespace test {
+
+struct test_case
+{
+    std::string_view name;
+    std::function<void()> body;
+};
+
+namespace detail {
+inline unsigned int failed_checks = 0;
+
+constexpr auto printable(const auto& value)
+{
+    using value_t = std::decay_t<decltype(value)>;
+    if constexpr (std::is_enum_v<value_t>) {
+        return std::to_underlying(value);
+    } else if constexpr (std::is_same_v<value_t, char> ||
+                         std::is_same_v<value_t, unsigned char>) {
+        return static_cast<unsigned int>(value);
+    } else {
+        return value;
+    }
+}
+
+inline std::ostream& location(
+  const std::source_location& where = std::source_location::current())
+{
+    return std::cerr << where.file_name() << ":" << where.line() << ": ";
+}
+}
+
+inline void expect(
+  bool condition,
+  std::string_view description = "",
+  const std::source_location& where = std::source_location::current())
+{
+    if (!condition) {
+        ++detail::failed_checks;
+        detail::location(where) << "check failed " << description << "\n";
+    }
+}
+
+template<typename Lhs, typename Rhs>
+void expect_eq(
+  const Lhs& lhs,
+  const Rhs& rhs,
+  const std::source_location& where = std::source_location::current())
+{
+    if (!(lhs == rhs)) {
+        ++detail::failed_checks;
+        detail::location(where)
+          << std::hex << "expected 0x" << detail::printable(rhs) << ", got 0x"
+          << detail::printable(lhs) << std::dec << "\n";
+    }
+}
+
+// Runs all test cases, `setup` is called before each of them.
+//
+// @return process exit code
+inline int run(std::span<const test_case> tests,
+               const std::function<void()>& setup = [] {})
+{
+    unsigned int failed_tests = 0;
+    for (const auto& test : tests) {
+        const auto failed_before = detail::failed_checks;
+        setup();
+        test.body();
+        const bool passed = (detail::failed_checks == failed_before);
+        failed_tests += passed ? 0 : 1;
+        std::cout << (passed ? "[ OK ] " : "[FAIL] ") << test.name << "\n";
+    }
+    std::cout << (tests.size() - failed_tests) << "/" << tests.size()
+              << " tests passed\n";
+    return failed_tests == 0 ? 0 : 1;
+}
+
+}
+
+#endif
@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+#
+# Author: Patryk Jaworski <regalis@regalis.tech>
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+
+
+"""Unit tests of tools/framing.py (CRC, COBS, frame reader)."""
+
+import pathlib
+import sys
+import unittest
+
+sys.path.insert(0, str(pathlib.Path(__file__).resolve().parents[2] / 'tools'))
+
+import framing  # noqa: E402
+
+CHECK = b'123456789'
+
+
+class CrcTest(unittest.TestCase):
+    def test_check_values(self):
+        self.assertEqual(framing.crc16(CHECK), 0x29b1)
+        self.assertEqual(framing.crc32(CHECK), 0xcbf43926)
+
+    def test_empty_input(self):
+        self.assertEqual(framing.crc16(b''), 0xffff)
+        self.assertEqual(framing.crc32(b''), 0)
+
+
+class CobsTest(unittest.TestCase):
+    # The same vectors as tests/unit/framing.cpp (without the delimiter)
+    VECTORS = [
+        (b'\x00', b'\x01\x01'),
+        (b'\x00\x00', b'\x01\x01\x01'),
+        (b'\x11\x22\x00\x33', b'\x03\x11\x22\x02\x33'),
+        (b'\x11\x00\x00\x00', b'\x02\x11\x01\x01\x01'),
+        (b'\x11\x22\x33\x44', b'\x05\x11\x22\x33\x44'),
+        (b'', b'\x01'),
+    ]
+
+    def test_known_encodings(self):
+        for data, encoded in self.VECTORS:
+            with self.subTest(data=data):
+                self.assertEqual(framing.cobs_encode(data), encoded)
+                self.assertEqual(framing.cobs_decode(encoded), data)
+
+    def test_runs_of_254_bytes(self):
+        data = bytes(range(1, 256))
+        # 01..fe: a single full block
+        self.assertEqual(framing.cobs_encode(data[:254]),
+                         b'\xff' + data[:254])
+        # 01..ff: a full block and a block of one byte
+        self.assertEqual(framing.cobs_encode(data),
+                         b'\xff' + data[:254] + b'\x02\xff')
+        # 00..fe: a zero in front of the full block
+        self.assertEqual(framing.cobs_encode(b'\x00' + data[:254]),
+                         b'\x01\xff' + data[:254])
+        # A zero right after a full block
+        self.assertEqual(framing.cobs_encode(data[:254] + b'\x00'),
+                         b'\xff' + data[:254] + b'\x01\x01')
+
+    def test_round_trip(self):
+        for size in (0, 1, 253, 254, 255, 508, 509, 1000):
+            for pattern in (b'\x01', b'\x00', b'\x5a\x00\xff'):
+                data = (pattern * size)[:size]
+                with self.subTest(size=size, pattern=pattern):
+                    encoded = framing.cobs_encode(data)
+                    self.assertNotIn(framing.DELIMITER, encoded)
+                    self.assertEqual(framing.cobs_decode(encoded), data)
+
+    def test_malformed(self):
+        for encoded in (b'\x05\x11\x22', b'\x03\x11\x00', b'\x00'):
+            with self.subTest(encoded=encoded):
+                with self.assertRaises(ValueError):
+                    framing.cobs_decode(encoded)
+
+
+class FrameReaderTest(unittest.TestCase):
+    def test_frames_split_across_reads(self):
+        for checksum in sorted(framing.CHECKSUMS):
+            with self.subTest(checksum=checksum):
+                stream = b''.join(framing.encode_frame(payload, checksum)
+                                  for payload in (b'first', b'\x00' * 3,
+                                                  bytes(300)))
+                reader = framing.FrameReader(checksum)
+                payloads = []
+                for position in range(0, len(stream), 7):
+                    payloads += reader.feed(stream[position:position + 7])
+                self.assertEqual(payloads, [b'first', b'\x00' * 3,
+                                            bytes(300)])
+                self.assertEqual(reader.frames, 3)
+
+    def test_crc16_frame(self):
+        frame = framing.encode_frame(CHECK)
+        self.assertEqual(frame[-1], framing.DELIMITER)
+        self.assertEqual(framing.cobs_decode(frame[:-1]),
+                         CHECK + b'\xb1\x29')
+
+    def test_errors_are_counted(self):
+        good = framing.encode_frame(b'payload')
+        corrupted = bytearray(good)
+        corrupted[2] ^= 0x01
+        reader = framing.FrameReader()
+        payloads = list(reader.feed(b'\x00' + bytes(corrupted) +
+                                    b'\x05\x11\x00' + b'\x02\x11\x00' +
+                                    good))
+        self.assertEqual(payloads, [b'payload'])
+        self.assertEqual(reader.frames, 1)
+        self.assertEqual(reader.crc_errors, 1)
+        # A truncated block, a frame shorter than the CRC
+        self.assertEqual(reader.malformed, 2)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,213 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+#
+# Author: Patryk Jaworski <regalis@regalis.tech>
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+
+
+"""Unit tests of tools/log_decode.py (wire format, message IDs)."""
+
+import io
+import pathlib
+import struct
+import sys
+import tempfile
+import unittest
+
+sys.path.insert(0, str(pathlib.Path(__file__).resolve().parents[2] / 'tools'))
+
+import log_decode  # noqa: E402
+
+
+def varint(value):
+    """encode_varint() of src/include/logging.hpp."""
+    output = bytearray()
+    while value >= 0x80:
+        output.append((value & 0x7f) | 0x80)
+        value >>= 7
+    output.append(value)
+    return bytes(output)
+
+
+def zigzag(value):
+    """zigzag() of src/include/logging.hpp (int32_t to uint32_t)."""
+    return ((value << 1) ^ (value >> 31)) & 0xffffffff
+
+
+def record(*fields):
+    data = b''.join(varint(field) for field in fields)
+    return bytes([len(data)]) + data
+
+
+def elf(base, anchor, entries):
+    """A little-endian ELF32 file with the anchor and the entries in .rodata.
+
+    `entries` maps the offsets from `base` to the text of the messages.
+    """
+    rodata = bytearray(max([anchor, *entries]) + 64)
+    strtab = bytearray(b'\0')
+    symbols = [struct.pack('<IIIBBH', 0, 0, 0, 0, 0, 0)]
+
+    def symbol(name, offset, shndx=1):
+        symbols.append(struct.pack('<IIIBBH', len(strtab), base + offset, 0,
+                                   0, 0, shndx))
+        strtab.extend(name.encode() + b'\0')
+
+    symbol(log_decode.ANCHOR, anchor)
+    for index, (offset, text) in enumerate(sorted(entries.items())):
+        rodata[offset:offset + len(text) + 1] = text.encode() + b'\0'
+        symbol(f'{log_decode.ENTRY_PREFIX}{index}', offset)
+    # Undefined symbols are ignored
+    symbol(f'{log_decode.ENTRY_PREFIX}undefined', 0, shndx=0)
+
+    symtab = b''.join(symbols)
+    header_size = 52
+    rodata_offset = header_size
+    symtab_offset = rodata_offset + len(rodata)
+    strtab_offset = symtab_offset + len(symtab)
+    sections_offset = strtab_offset + len(strtab)
+    sections = [
+        (0,) * 10,
+        (0, 1, 2, base, rodata_offset, len(rodata), 0, 0, 4, 0),
+        (0, 2, 0, 0, symtab_offset, len(symtab), 3, 1, 4, 16),
+        (0, 3, 0, 0, strtab_offset, len(strtab), 0, 0, 1, 0),
+    ]
+    header = (b'\x7fELF\x01\x01\x01' + bytes(9) +
+              struct.pack('<HHIIIIIHHHHHH', 2, 40, 1, 0, 0, sections_offset,
+                          0, header_size, 0, 0, 40, len(sections), 0))
+    return (header + rodata + symtab + strtab +
+            b''.join(struct.pack('<10I', *section) for section in sections))
+
+
+class VarintTest(unittest.TestCase):
+    def test_decodes_the_encoder_output(self):
+        for value in (0, 1, 0x7f, 0x80, 300, 0x3fff, 0x4000, 0xffffffff):
+            with self.subTest(value=value):
+                data = varint(value) + b'\x2a'
+                self.assertEqual(log_decode.read_varint(data, 0),
+                                 (value, len(data) - 1))
+
+    def test_known_encodings(self):
+        self.assertEqual(log_decode.read_varint(b'\xac\x02', 0), (300, 2))
+        self.assertEqual(
+            log_decode.read_varint(b'\xff\xff\xff\xff\x0f', 0)[0], 0xffffffff)
+
+    def test_truncated_varint(self):
+        with self.assertRaises(IndexError):
+            log_decode.read_varint(b'\x80\x80', 0)
+
+
+class ZigzagTest(unittest.TestCase):
+    def test_known_values(self):
+        for encoded, value in ((0, 0), (1, -1), (2, 1), (3, -2),
+                               (0xfffffffe, 0x7fffffff),
+                               (0xffffffff, -0x80000000)):
+            with self.subTest(value=value):
+                self.assertEqual(log_decode.unzigzag(encoded), value)
+
+    def test_round_trip(self):
+        for value in (-0x80000000, -65536, -129, -1, 0, 1, 127, 0x7fffffff):
+            with self.subTest(value=value):
+                self.assertEqual(log_decode.unzigzag(zigzag(value)), value)
+
+
+class FormatTest(unittest.TestCase):
+    def test_arguments(self):
+        message = log_decode.Message('Iuicbf2:{} {} {:c} {} {}')
+        self.assertEqual(message.level, 'info')
+        self.assertEqual(message.types, ['u', 'i', 'c', 'b', 'f2'])
+        text = log_decode.format_message(
+            message, [7, zigzag(-42), ord('x'), 1, zigzag(-150)])
+        self.assertEqual(text, '7 -42 x true -1.50')
+
+    def test_specs(self):
+        message = log_decode.Message('Wuuic:{{{:04x}}} {:b} {:5d} {:d}')
+        self.assertEqual(message.level, 'warning')
+        text = log_decode.format_message(
+            message, [0xbeef, 5, zigzag(-3), 0xe9])
+        self.assertEqual(text, '{beef} 101    -3 233')
+
+
+class DecodeTest(unittest.TestCase):
+    messages = {
+        0: log_decode.Message('I:boot'),
+        12: log_decode.Message('Ei:error {}'),
+    }
+
+    def test_record(self):
+        message, arguments, delta = log_decode.decode_record(
+            self.messages, record(12, zigzag(-5), 1000)[1:])
+        self.assertIs(message, self.messages[12])
+        self.assertEqual(arguments, [zigzag(-5)])
+        self.assertEqual(delta, 1000)
+
+    def test_malformed_records(self):
+        for data in (record(5, 0)[1:],       # unknown message
+                     record(12, 0)[1:],      # missing timestamp
+                     record(0, 0, 0)[1:],    # trailing data
+                     b'\x0c\x80'):           # truncated varint
+            with self.subTest(data=data):
+                self.assertIsNone(
+                    log_decode.decode_record(self.messages, data))
+
+    def test_stream(self):
+        stream = io.BytesIO(b'\x07' + record(0, 1_500_000) +
+                            record(12, zigzag(-1), 250_000))
+        output = io.StringIO()
+        log_decode.decode(self.messages, stream, output)
+        self.assertEqual(output.getvalue().splitlines(), [
+            '[    1.500000] info    boot',
+            '[    1.750000] error   error -1',
+            '(1 bytes skipped)',
+        ])
+
+
+class LoadMessagesTest(unittest.TestCase):
+    def load(self, data):
+        with tempfile.TemporaryDirectory() as directory:
+            path = pathlib.Path(directory) / 'firmware.elf'
+            path.write_bytes(data)
+            return log_decode.load_messages(path)
+
+    def test_ids_are_offsets_from_the_anchor(self):
+        messages = self.load(elf(0x10004000, 0x10, {
+            0x20: 'Iu:count {}',
+            0x30: 'D:idle',
+            0x00: 'E:below the anchor',
+        }))
+        self.assertEqual(sorted(messages), [0x10, 0x20, 0xfffffff0])
+        self.assertEqual(messages[0x10].text, 'count {}')
+        self.assertEqual(messages[0x20].level, 'debug')
+        self.assertEqual(messages[0xfffffff0].text, 'below the anchor')
+
+        stream = io.BytesIO(record(0xfffffff0, 1))
+        output = io.StringIO()
+        log_decode.decode(messages, stream, output)
+        self.assertEqual(output.getvalue(),
+                         '[    0.000001] error   below the anchor\n')
+
+    def test_missing_anchor(self):
+        data = elf(0x10004000, 0, {0x10: 'I:text'})
+        data = data.replace(log_decode.ANCHOR.encode(),
+                            b'x' * len(log_decode.ANCHOR))
+        with self.assertRaises(ValueError):
+            self.load(data)
+
+
+if __name__ == '__main__':
+    unittest.main()
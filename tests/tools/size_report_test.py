@@ -0,0 +1,61 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+#
+# Author: Patryk Jaworski <regalis@regalis.tech>
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+
+"""Unit tests of tools/size_report.py (loop detection of estimate())."""
+
+import pathlib
+import sys
+import unittest
+
+sys.path.insert(0, str(pathlib.Path(__file__).resolve().parents[2] / 'tools'))
+
+import size_report  # noqa: E402
+
+
+def loop(branch):
+    """A countdown loop closed by the given branch mnemonic."""
+    return [
+        (0x100, 'movs', 'r3, #10'),
+        (0x102, 'subs', 'r3, #1'),
+        (0x104, 'cmp', 'r3, #0'),
+        (0x106, branch, '102 <wait+0x2>'),
+        (0x108, 'bx', 'lr'),
+    ]
+
+
+class EstimateTest(unittest.TestCase):
+    def test_conditional_branches_close_loops(self):
+        for branch in ('bne.n', 'bls.n', 'blt.n', 'ble.n', 'bls', 'blt.w'):
+            with self.subTest(branch=branch):
+                loops = size_report.estimate(loop(branch))['loops']
+                self.assertEqual(len(loops), 1)
+                self.assertEqual(loops[0]['start'], '0x00000102')
+                self.assertEqual(loops[0]['instructions'], 3)
+                self.assertEqual(loops[0]['cycles_per_iteration'], 4)
+
+    def test_calls_are_not_loops(self):
+        for call in ('bl', 'blx', 'bl.w'):
+            with self.subTest(call=call):
+                self.assertEqual(size_report.estimate(loop(call))['loops'], [])
+
+
+if __name__ == '__main__':
+    unittest.main()
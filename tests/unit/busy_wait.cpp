@@ -0,0 +1,111 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#include <array>
+
+#include "busy_wait.hpp"
+#include "clocks.hpp"
+#include "reset.hpp"
+#include "rp2040_simulator.hpp"
+#include "test.hpp"
+#include "xosc.hpp"
+
+namespace {
+
+namespace sim = hwio::simulator;
+using busy_wait::result;
+using busy_wait::sites;
+
+const std::array tests{
+  test::test_case{"ready hardware is recorded as a single short wait",
+                  [] {
+                      test::expect(busy_wait::until(sites::pll_lock, [] {
+                                       return true;
+                                   }) == result::ready);
+                      const auto& stats =
+                        busy_wait::statistics(sites::pll_lock);
+                      test::expect_eq(stats.calls, 1U);
+                      test::expect_eq(stats.timeouts, 0U);
+                      test::expect(stats.last_cycles <= 20U);
+                      test::expect_eq(stats.max_cycles, stats.last_cycles);
+                  }},
+  test::test_case{"waits are bounded by the budget",
+                  [] {
+                      constexpr uint32_t budget = 10'000;
+                      test::expect(busy_wait::until(
+                                     sites::xosc_stable,
+                                     [] { return false; },
+                                     budget) == result::timeout);
+                      const auto& stats =
+                        busy_wait::statistics(sites::xosc_stable);
+                      test::expect_eq(stats.calls, 1U);
+                      test::expect_eq(stats.timeouts, 1U);
+                      test::expect(stats.last_cycles >= budget);
+                      test::expect(stats.last_cycles < budget + 100);
+                  }},
+  test::test_case{"releasing a subsystem is a bounded wait",
+                  [] {
+                      test::expect(reset::release_subsystem_wait(
+                                     reset::subsystems::pwm) == result::ready);
+                      test::expect_eq(
+                        busy_wait::statistics(sites::reset_done).calls, 1U);
+                  }},
+  test::test_case{"a PLL which never locks is reported",
+                  [] {
+                      test::expect(clocks::pll_init<platform::pll::sys>(
+                                     1, 1'500'000'000, 6, 2) ==
+                                   result::timeout);
+                      const auto& stats =
+                        busy_wait::statistics(sites::pll_lock);
+                      test::expect_eq(stats.timeouts, 1U);
+                      test::expect(stats.last_cycles >=
+                                   busy_wait::default_budget);
+                      // The post dividers are left untouched
+                      test::expect_eq(sim::registers().writes(
+                                        platform::pll::sys::prim::addr),
+                                      0U);
+                  }},
+  test::test_case{"the oscillator startup is bounded",
+                  [] {
+                      test::expect(xosc::init() == result::timeout);
+                      sim::registers().poke(
+                        platform::xosc::status::addr,
+                        1U << std::to_underlying(
+                          platform::xosc::status_bits::stable));
+                      test::expect(xosc::init() == result::ready);
+                      const auto& stats =
+                        busy_wait::statistics(sites::xosc_stable);
+                      test::expect_eq(stats.calls, 2U);
+                      test::expect_eq(stats.timeouts, 1U);
+                  }},
+};
+
+}
+
+int main()
+{
+    return test::run(tests, [] {
+        rp2040_simulator::setup();
+        busy_wait::reset_statistics();
+    });
+}
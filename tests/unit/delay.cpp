@@ -0,0 +1,109 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <array>
+#include <vector>
+
+#include "delay.hpp"
+#include "rp2040_simulator.hpp"
+#include "systick.hpp"
+#include "test.hpp"
+
+namespace {
+
+namespace sim = hwio::simulator;
+using namespace platform::m0plus;
+
+static_assert(board::clocks::sys_clk_hz == 125'000'000);
+static_assert(cycles_for_ns(8) == 1);
+static_assert(cycles_for_ns(9) == 2);
+static_assert(cycles_for_ns(5000) == 625);
+static_assert(cycles_for_ns(1'000'000) == 125'000);
+
+const std::array tests{
+  test::test_case{"short delays are exact-count loops",
+                  [] {
+                      delay_ns<5000>();
+                      test::expect_eq(sim::core::delayed_cycles, 625U);
+                      delay_cycles<sim::core::max_delay_cycles>();
+                      test::expect_eq(sim::core::delayed_cycles,
+                                      625U + sim::core::max_delay_cycles);
+                      test::expect_eq(sim::registers().total_reads(), 0U);
+                  }},
+  test::test_case{"long delays are measured with SysTick",
+                  [] {
+                      delay_ns<1'000'000>();
+                      test::expect_eq(sim::core::delayed_cycles, 0U);
+                      test::expect(syst_csr::get_bit(syst_csr_bits::enable));
+                      test::expect_eq(sim::registers().peek(syst_rvr::addr),
+                                      systick::counter_mask);
+                      constexpr auto cycles_per_read =
+                        rp2040_simulator::systick_cycles_per_read;
+                      test::expect(sim::registers().reads(syst_cvr::addr) *
+                                     cycles_per_read >=
+                                   125'000U);
+                  }},
+  test::test_case{"start restores the range of a counter with another reload",
+                  [] {
+                      static std::vector<sim::address_t> writes;
+                      writes.clear();
+                      for (const auto addr :
+                           {syst_csr::addr, syst_rvr::addr, syst_cvr::addr}) {
+                          sim::registers().on_write(
+                            addr, [](sim::address_t target, sim::value_t) {
+                                writes.push_back(target);
+                            });
+                      }
+                      sim::registers().poke(syst_csr::addr,
+                                            bitmask(syst_csr_bits::enable));
+                      sim::registers().poke(syst_rvr::addr, 1000);
+                      sim::registers().poke(syst_cvr::addr, 0x123);
+                      systick::start();
+                      test::expect(writes ==
+                                   std::vector<sim::address_t>{syst_csr::addr,
+                                                               syst_rvr::addr,
+                                                               syst_cvr::addr,
+                                                               syst_csr::addr});
+                      test::expect_eq(sim::registers().peek(syst_rvr::addr),
+                                      systick::counter_mask);
+                      test::expect_eq(sim::registers().peek(syst_cvr::addr),
+                                      0U);
+                      test::expect(syst_csr::get_bit(syst_csr_bits::enable));
+                      // Already running with the full range
+                      writes.clear();
+                      systick::start();
+                      test::expect(writes.empty());
+                  }},
+  test::test_case{"SysTick intervals survive the wrap around",
+                  [] {
+                      test::expect_eq(systick::elapsed(0x000010, 0xfffff0),
+                                      0x20U);
+                      test::expect_eq(systick::elapsed(0x500, 0x100), 0x400U);
+                  }},
+};
+
+}
+
+int main()
+{
+    return test::run(tests, rp2040_simulator::setup);
+}
@@ -0,0 +1,261 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#include <array>
+#include <cstddef>
+#include <span>
+
+#include "dma.hpp"
+#include "rp2040_simulator.hpp"
+#include "test.hpp"
+#include "uart.hpp"
+
+namespace {
+
+namespace sim = hwio::simulator;
+using namespace platform::dma;
+using tx_channel = platform::dma::channel<0>;
+using rx_channel = platform::dma::channel<1>;
+using receiver = uart::dma_receiver<uart::uart0, 1, 64>;
+
+constexpr platform::reg_val_t treq_shift = 15;
+constexpr platform::reg_val_t ring_size_shift = 6;
+constexpr platform::reg_val_t chain_to_shift = 11;
+
+static_assert(tx_channel::ctrl_trig::addr == 0x5000000c);
+static_assert(platform::dma::channel<11>::read_addr::addr == 0x500002c0);
+static_assert(dma::ctrl_value<tx_channel::ctrl_trig>(0, {}) ==
+              (0x3fU << treq_shift | bitmask(ctrl_bits::en,
+                                             ctrl_bits::incr_read,
+                                             ctrl_bits::incr_write)));
+static_assert(dma::ctrl_value<rx_channel::ctrl_trig>(
+                1,
+                {.size = dma::data_size::size_word,
+                 .increment_read = false,
+                 .request = dma::treq::uart1_rx,
+                 .ring_bytes = 256,
+                 .ring_on_write = true}) ==
+              (23U << treq_shift | 1U << chain_to_shift |
+               8U << ring_size_shift |
+               bitmask(ctrl_bits::en,
+                       ctrl_bits::data_size1,
+                       ctrl_bits::incr_write,
+                       ctrl_bits::ring_sel)));
+
+void set_remaining(platform::reg_val_t count)
+{
+    sim::registers().poke(rx_channel::trans_count::addr, count);
+}
+
+const std::array tests{
+  test::test_case{"the DMA is released from reset",
+                  [] {
+                      test::expect(dma::init() == busy_wait::result::ready);
+                      test::expect(platform::registers::reset_done::get_bit(
+                        reset::subsystems::dma));
+                  }},
+  test::test_case{"write_dma programs a channel paced by the TX DREQ",
+                  [] {
+                      const std::array<std::byte, 100> frame{};
+                      const auto done = uart::uart0::write_dma<0>(frame);
+                      auto& file = sim::registers();
+                      test::expect_eq(file.peek(tx_channel::read_addr::addr),
+                                      dma::address_of(frame.data()));
+                      test::expect_eq(
+                        file.peek(tx_channel::write_addr::addr),
+                        platform::uart::uart0::uartdr::addr);
+                      test::expect_eq(file.peek(tx_channel::trans_count::addr),
+                                      100U);
+                      test::expect_eq(
+                        file.peek(tx_channel::ctrl_trig::addr),
+                        20U << treq_shift |
+                          bitmask(ctrl_bits::en, ctrl_bits::incr_read));
+                      test::expect(
+                        platform::uart::uart0::uartdmacr::get_bit(
+                          platform::uart::uartdmacr_bits::txdmae));
+                      // The trigger is written last
+                      test::expect_eq(file.writes(tx_channel::ctrl_trig::addr),
+                                      1U);
+                      test::expect(done.is_done());
+                  }},
+  test::test_case{"a channel chains to itself (no chaining)",
+                  [] {
+                      using channel = platform::dma::channel<5>;
+                      const std::array<std::byte, 4> frame{};
+                      const auto done = uart::uart0::write_dma<5>(frame);
+                      const auto ctrl =
+                        sim::registers().peek(channel::ctrl_trig::addr);
+                      test::expect_eq((ctrl >> chain_to_shift) & 0xfU, 5U);
+                      test::expect(done.is_done());
+                  }},
+  test::test_case{"the completion token follows the BUSY flag",
+                  [] {
+                      const std::array<std::byte, 4> frame{};
+                      const auto done = uart::uart0::write_dma<0>(frame);
+                      tx_channel::ctrl_trig::set_bits(ctrl_bits::busy);
+                      test::expect(!done.is_done());
+                      tx_channel::ctrl_trig::reset_bits(ctrl_bits::busy);
+                      test::expect(done.is_done());
+                  }},
+  test::test_case{"waiting for a transfer is bounded",
+                  [] {
+                      const std::array<std::byte, 4> frame{};
+                      const auto done = uart::uart0::write_dma<0>(frame);
+                      test::expect(done.wait() == busy_wait::result::ready);
+                      tx_channel::ctrl_trig::set_bits(ctrl_bits::busy);
+                      test::expect(done.wait(1000) ==
+                                   busy_wait::result::timeout);
+                      const auto& stats =
+                        busy_wait::statistics(busy_wait::sites::dma_done);
+                      test::expect_eq(stats.calls, 2U);
+                      test::expect_eq(stats.timeouts, 1U);
+                  }},
+  test::test_case{"abort waits for the channel to stop",
+                  [] {
+                      using channel = dma::channel<3>;
+                      test::expect(channel::abort() ==
+                                   busy_wait::result::ready);
+                      test::expect_eq(
+                        sim::registers().writes(chan_abort::addr), 1U);
+                      // The channel never stops
+                      sim::registers().on_write(
+                        chan_abort::addr, [](sim::address_t, sim::value_t) {});
+                      test::expect(channel::abort() ==
+                                   busy_wait::result::timeout);
+                      test::expect_eq(
+                        busy_wait::statistics(busy_wait::sites::dma_abort)
+                          .timeouts,
+                        1U);
+                  }},
+  test::test_case{"the receiver runs in ring mode",
+                  [] {
+                      receiver::start();
+                      auto& file = sim::registers();
+                      test::expect_eq(file.peek(rx_channel::read_addr::addr),
+                                      platform::uart::uart0::uartdr::addr);
+                      test::expect_eq(
+                        file.peek(rx_channel::write_addr::addr) % 64, 0U);
+                      test::expect_eq(file.peek(rx_channel::trans_count::addr),
+                                      0xffffffffU);
+                      test::expect_eq(
+                        file.peek(rx_channel::ctrl_trig::addr),
+                        21U << treq_shift | 1U << chain_to_shift |
+                          6U << ring_size_shift |
+                          bitmask(ctrl_bits::en,
+                                  ctrl_bits::incr_write,
+                                  ctrl_bits::ring_sel));
+                  }},
+  test::test_case{"received bytes are counted with TRANS_COUNT",
+                  [] {
+                      receiver::start();
+                      test::expect_eq(receiver::available(), 0U);
+                      set_remaining(0xffffffff - 40);
+                      test::expect_eq(receiver::available(), 40U);
+                      std::array<std::byte, 32> data{};
+                      test::expect_eq(receiver::read_some(data), 32U);
+                      test::expect_eq(receiver::available(), 8U);
+                      // Wraps around the end of the ring
+                      set_remaining(0xffffffff - 90);
+                      test::expect_eq(receiver::read_some(data), 32U);
+                      test::expect_eq(receiver::read_some(data), 26U);
+                      test::expect_eq(receiver::read_some(data), 0U);
+                      test::expect_eq(receiver::dropped(), 0U);
+                  }},
+  test::test_case{"receive errors are taken from UARTRIS",
+                  [] {
+                      using uart_registers = platform::uart::uart0;
+                      using platform::uart::uartris_bits;
+                      receiver::start();
+                      uart::uart0::reset_stats();
+                      auto& file = sim::registers();
+                      file.poke(uart_registers::uartris::addr,
+                                bitmask(uartris_bits::oeris,
+                                        uartris_bits::feris,
+                                        uartris_bits::rxris));
+                      std::array<std::byte, 8> data{};
+                      test::expect_eq(receiver::read_some(data), 0U);
+                      const auto stats = uart::uart0::stats();
+                      test::expect_eq(stats.overrun_errors, 1U);
+                      test::expect_eq(stats.framing_errors, 1U);
+                      test::expect_eq(stats.parity_errors, 0U);
+                      test::expect_eq(stats.break_errors, 0U);
+                      // Only the counted flags are cleared
+                      test::expect_eq(
+                        file.peek(uart_registers::uartris::addr),
+                        bitmask(uartris_bits::rxris));
+                      // Cleared flags are not counted again
+                      test::expect_eq(receiver::read_some(data), 0U);
+                      test::expect_eq(uart::uart0::stats().overrun_errors, 1U);
+                  }},
+  test::test_case{"an error raised while clearing is not lost",
+                  [] {
+                      using uart_registers = platform::uart::uart0;
+                      using platform::uart::uartris_bits;
+                      receiver::start();
+                      uart::uart0::reset_stats();
+                      auto& file = sim::registers();
+                      file.poke(uart_registers::uartris::addr,
+                                bitmask(uartris_bits::oeris));
+                      // A parity error right after the first read
+                      file.on_read(uart_registers::uartris::addr,
+                                   [raised = false](sim::address_t addr,
+                                                    sim::value_t current)
+                                     mutable {
+                                       if (!raised) {
+                                           raised = true;
+                                           sim::registers().poke(
+                                             addr,
+                                             current |
+                                               bitmask(uartris_bits::peris));
+                                       }
+                                       return current;
+                                   });
+                      std::array<std::byte, 8> data{};
+                      test::expect_eq(receiver::read_some(data), 0U);
+                      test::expect_eq(uart::uart0::stats().overrun_errors, 1U);
+                      test::expect_eq(uart::uart0::stats().parity_errors, 0U);
+                      test::expect_eq(receiver::read_some(data), 0U);
+                      test::expect_eq(uart::uart0::stats().overrun_errors, 1U);
+                      test::expect_eq(uart::uart0::stats().parity_errors, 1U);
+                  }},
+  test::test_case{"overwritten bytes are counted as dropped",
+                  [] {
+                      receiver::start();
+                      const auto before = receiver::dropped();
+                      set_remaining(0xffffffff - 70);
+                      test::expect_eq(receiver::available(), 64U);
+                      std::array<std::byte, 128> data{};
+                      test::expect_eq(receiver::read_some(data), 64U);
+                      test::expect_eq(receiver::dropped() - before, 6U);
+                  }},
+};
+
+}
+
+int main()
+{
+    return test::run(tests, [] {
+        rp2040_simulator::setup();
+        busy_wait::reset_statistics();
+    });
+}
@@ -0,0 +1,147 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <array>
+
+#include "pwm.hpp"
+#include "reset.hpp"
+#include "rp2040_simulator.hpp"
+#include "test.hpp"
+#include "uart.hpp"
+
+namespace {
+
+namespace sim = hwio::simulator;
+
+using uart_registers = platform::uart::uart0;
+
+static_assert(uart::max_baudrate() == 7'812'500);
+static_assert(uart::baudrate<115200>().divisors.integer_divisor == 67);
+static_assert(uart::baudrate<115200>().divisors.fractional_divisor == 52);
+static_assert(uart::baudrate<115200>().real_baudrate == 115207);
+static_assert(uart::baudrate<115200>().error_ppm == 60);
+static_assert(uart::baudrate<7'812'500, 0>().real_baudrate == 7'812'500);
+static_assert(uart::solve_baudrate(6'000'000).error_ppm == 4016);
+static_assert(uart::solve_baudrate(120).in_range);
+static_assert(!uart::solve_baudrate(119).in_range);
+static_assert(!uart::solve_baudrate(8'000'000).in_range);
+static_assert(uart::solve_baudrate(115200, 1'843'200).error_ppm == 0);
+
+const std::array tests{
+  test::test_case{
+    "reset releases the subsystem",
+    [] {
+        reset::reset_subsystem(reset::subsystems::pwm);
+        test::expect(!platform::registers::reset_done::get_bit(
+          reset::subsystems::pwm));
+        test::expect(reset::release_subsystem_wait(reset::subsystems::pwm) ==
+                     busy_wait::result::ready);
+        test::expect(
+          platform::registers::reset_done::get_bit(reset::subsystems::pwm));
+        test::expect_eq(
+          sim::registers().reads(platform::registers::reset::addr), 0U);
+    }},
+  test::test_case{
+    "uart init configures the baudrate and the frame format",
+    [] {
+        const auto real_baudrate = uart::uart0::init(9600);
+        test::expect_eq(real_baudrate, 9600U);
+        test::expect_eq(sim::registers().peek(uart_registers::uartibrd::addr),
+                        813U);
+        test::expect_eq(sim::registers().peek(uart_registers::uartfbrd::addr),
+                        51U);
+        test::expect_eq(sim::registers().peek(uart_registers::uartlcr_h::addr),
+                        0x70U);
+        test::expect_eq(sim::registers().peek(uart_registers::uartcr::addr),
+                        0x301U);
+        test::expect_eq(
+          sim::registers().reads(uart_registers::uartibrd::addr), 0U);
+        test::expect_eq(
+          sim::registers().reads(uart_registers::uartfbrd::addr), 0U);
+    }},
+  test::test_case{
+    "uart init with a compile-time baudrate matches the runtime solver",
+    [] {
+        const auto real_baudrate = uart::uart0::init<115200>();
+        test::expect_eq(real_baudrate, 115207U);
+        test::expect_eq(sim::registers().peek(uart_registers::uartibrd::addr),
+                        67U);
+        test::expect_eq(sim::registers().peek(uart_registers::uartfbrd::addr),
+                        52U);
+        const auto& [baud, runtime_baudrate] = uart::baudrate_calculate(115200);
+        test::expect_eq(baud.integer_divisor, 67U);
+        test::expect_eq(baud.fractional_divisor, 52U);
+        test::expect_eq(runtime_baudrate, real_baudrate);
+        test::expect_eq(uart::uart0::set_baudrate<9600>(), 9600U);
+        test::expect_eq(sim::registers().peek(uart_registers::uartibrd::addr),
+                        813U);
+        test::expect_eq(sim::registers().peek(uart_registers::uartfbrd::addr),
+                        51U);
+    }},
+  test::test_case{
+    "uart init reports a UART stuck in reset",
+    [] {
+        // RESET_DONE never follows
+        sim::registers().on_write(platform::registers::reset::addr,
+                                  [](sim::address_t, sim::value_t) {});
+        sim::registers().poke(platform::registers::reset_done::addr, 0);
+        test::expect_eq(uart::uart0::init(9600), 0U);
+        test::expect_eq(uart::uart0::init<115200>(), 0U);
+        test::expect_eq(sim::registers().writes(uart_registers::uartcr::addr),
+                        0U);
+    }},
+  test::test_case{
+    "uart putc waits for space in the FIFO",
+    [] {
+        constexpr auto txff = 1U << 5;
+        sim::registers().poke(uart_registers::uartfr::addr, txff);
+        sim::registers().on_read(
+          uart_registers::uartfr::addr,
+          [](sim::address_t addr, sim::value_t value) -> sim::value_t {
+              // The FIFO drains after a few polls
+              return sim::registers().reads(addr) > 3 ? value & ~txff : value;
+          });
+        uart::uart0::putc('x');
+        test::expect_eq(sim::registers().reads(uart_registers::uartfr::addr),
+                        4U);
+        test::expect_eq(sim::registers().peek(uart_registers::uartdr::addr),
+                        static_cast<sim::value_t>('x'));
+    }},
+  test::test_case{
+    "pwm enable is a single store",
+    [] {
+        pwm::slice3::enable();
+        test::expect_eq(sim::registers().peek(platform::pwm::ch3::csr::addr),
+                        1U);
+        test::expect_eq(sim::registers().total_reads(), 0U);
+        test::expect_eq(sim::registers().total_writes(), 1U);
+        pwm::slice3::disable();
+        test::expect_eq(sim::registers().peek(platform::pwm::ch3::csr::addr),
+                        0U);
+    }},
+};
+
+}
+
+int main()
+{
+    return test::run(tests, rp2040_simulator::setup);
+}
@@ -0,0 +1,190 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "format.hpp"
+#include "rp2040_simulator.hpp"
+#include "test.hpp"
+#include "uart.hpp"
+
+namespace {
+
+struct string_sink
+{
+    static inline std::string text;
+    static inline unsigned int calls = 0;
+
+    static void puts(std::string_view data)
+    {
+        text += data;
+        ++calls;
+    }
+};
+
+template<typename... Args>
+std::string formatted(format::format_string<Args...> fmt, const Args&... args)
+{
+    string_sink::text.clear();
+    format::print(string_sink{}, fmt, args...);
+    return string_sink::text;
+}
+
+static_assert(format::detail::divide_by_100(43698) == 436);
+static_assert(format::detail::divide_by_100(43699) == 436);
+static_assert(format::detail::divide_by_100(4294967295U) == 42949672);
+static_assert(format::detail::multiply_high(0xffffffff, 0xffffffff) ==
+              0xfffffffe);
+
+const std::array tests{
+  test::test_case{"text and escaped braces are copied",
+                  [] {
+                      test::expect_eq(formatted("plain text"),
+                                      std::string{"plain text"});
+                      test::expect_eq(formatted("{{}} {{{}}}", 1),
+                                      std::string{"{} {1}"});
+                  }},
+  test::test_case{"integers are printed in decimal",
+                  [] {
+                      test::expect_eq(formatted("{} {} {} {}", 0, 9, 10, 99),
+                                      std::string{"0 9 10 99"});
+                      test::expect_eq(formatted("{}", 4294967295U),
+                                      std::string{"4294967295"});
+                      test::expect_eq(
+                        formatted("{}", std::numeric_limits<int32_t>::min()),
+                        std::string{"-2147483648"});
+                      test::expect_eq(formatted("{}", uint8_t{200}),
+                                      std::string{"200"});
+                  }},
+  test::test_case{"decimal conversion matches the division",
+                  [] {
+                      std::array<char, 16> buffer{};
+                      for (uint32_t value = 1; value != 0;
+                           value = (value * 7) + 13) {
+                          const auto size =
+                            format::format_to(buffer, "{}", value);
+                          test::expect_eq(
+                            std::string_view{buffer.data(), size},
+                            std::string_view{std::to_string(value)});
+                          if (value > 0x10000000) {
+                              break;
+                          }
+                      }
+                  }},
+  test::test_case{"width, fill and base",
+                  [] {
+                      test::expect_eq(formatted("{:08x}", 0xbeef),
+                                      std::string{"0000beef"});
+                      test::expect_eq(formatted("{:X}", 0xbeefU),
+                                      std::string{"BEEF"});
+                      test::expect_eq(formatted("{:b}", 5),
+                                      std::string{"101"});
+                      test::expect_eq(formatted("[{:5}]", -42),
+                                      std::string{"[  -42]"});
+                      test::expect_eq(formatted("[{:05}]", -42),
+                                      std::string{"[-0042]"});
+                      test::expect_eq(formatted("[{:4}]", "ab"),
+                                      std::string{"[ab  ]"});
+                  }},
+  test::test_case{"fixed point numbers",
+                  [] {
+                      test::expect_eq(formatted("{}", format::fixed<2>{-1234}),
+                                      std::string{"-12.34"});
+                      test::expect_eq(formatted("{}", format::fixed<3>{5}),
+                                      std::string{"0.005"});
+                      test::expect_eq(formatted("{}", format::fixed<1>{-5}),
+                                      std::string{"-0.5"});
+                      test::expect_eq(
+                        formatted("{:07}", format::fixed<2>{250}),
+                        std::string{"0002.50"});
+                  }},
+  test::test_case{"characters, booleans and strings",
+                  [] {
+                      test::expect_eq(formatted("{}{:c}", 'o', 'k'),
+                                      std::string{"ok"});
+                      test::expect_eq(formatted("{:x}", 'A'),
+                                      std::string{"41"});
+                      test::expect_eq(formatted("{} {:d}", true, false),
+                                      std::string{"true 0"});
+                      const std::string_view view{"view"};
+                      test::expect_eq(formatted("{} {}", "literal", view),
+                                      std::string{"literal view"});
+                  }},
+  test::test_case{"characters above 0x7f are printed as unsigned",
+                  [] {
+                      const auto e_acute = static_cast<char>(0xe9);
+                      test::expect_eq(formatted("{:d}", e_acute),
+                                      std::string{"233"});
+                      test::expect_eq(formatted("{:X}", e_acute),
+                                      std::string{"E9"});
+                      std::array<char, 8> buffer{};
+                      const auto size =
+                        format::format_to(buffer, "{:d}", e_acute);
+                      test::expect_eq(std::string_view{buffer.data(), size},
+                                      std::string_view{"233"});
+                  }},
+  test::test_case{"format_to truncates to the buffer",
+                  [] {
+                      std::array<char, 4> buffer{};
+                      test::expect_eq(
+                        format::format_to(buffer, "{}", 123456), 4U);
+                      test::expect_eq(std::string_view{buffer.data(), 4},
+                                      std::string_view{"1234"});
+                  }},
+  test::test_case{"long text is flushed in chunks",
+                  [] {
+                      string_sink::calls = 0;
+                      const std::string expected(70, 'x');
+                      test::expect_eq(formatted("{}{}", expected, 7),
+                                      expected + "7");
+                      test::expect_eq(string_sink::calls, 3U);
+                  }},
+  test::test_case{"print writes to the UART",
+                  [] {
+                      using namespace platform::uart;
+                      auto& registers = hwio::simulator::registers();
+                      static std::string transmitted;
+                      transmitted.clear();
+                      registers.poke(uart0::uartfr::addr,
+                                     bit_value(uartfr_bits::txfe));
+                      registers.on_write(
+                        uart0::uartdr::addr,
+                        [](hwio::simulator::address_t,
+                           hwio::simulator::value_t value) {
+                            transmitted += static_cast<char>(value);
+                        });
+                      format::print(uart::uart0_tag, "id={:04x}\r\n", 0x2a);
+                      test::expect_eq(transmitted, std::string{"id=002a\r\n"});
+                  }},
+};
+
+}
+
+int main()
+{
+    return test::run(tests, rp2040_simulator::setup);
+}
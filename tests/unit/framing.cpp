@@ -0,0 +1,217 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "framing.hpp"
+#include "test.hpp"
+
+namespace {
+
+std::span<const std::byte> bytes(std::string_view text)
+{
+    return std::as_bytes(std::span{text});
+}
+
+std::vector<std::byte> encoded(std::span<const std::byte> data)
+{
+    std::vector<std::byte> output(framing::cobs::max_encoded_size(data.size()) +
+                                  1);
+    framing::cobs::encoder encoder{output};
+    encoder.put(data);
+    output.resize(encoder.finish());
+    return output;
+}
+
+std::vector<std::byte> from(std::initializer_list<unsigned int> values)
+{
+    std::vector<std::byte> result;
+    for (const auto value : values) {
+        result.push_back(static_cast<std::byte>(value));
+    }
+    return result;
+}
+
+constexpr auto check_input = [] {
+    std::array<std::byte, 9> data{};
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<std::byte>('1' + i);
+    }
+    return data;
+}();
+
+static_assert(framing::crc16::compute(check_input) == 0x29b1);
+static_assert(framing::crc32::compute(check_input) == 0xcbf43926);
+
+const std::array tests{
+  test::test_case{"CRC check values",
+                  [] {
+                      const auto check = bytes("123456789");
+                      test::expect_eq(framing::crc16::compute(check), 0x29b1U);
+                      test::expect_eq(framing::crc32::compute(check),
+                                      0xcbf43926U);
+                      framing::crc32 checksum;
+                      checksum.update(bytes("1234"));
+                      checksum.update(bytes("56789"));
+                      test::expect_eq(checksum.value(), 0xcbf43926U);
+                  }},
+  test::test_case{"COBS encoding",
+                  [] {
+                      test::expect(encoded(from({0x00})) ==
+                                   from({0x01, 0x01, 0x00}));
+                      test::expect(encoded(from({0x00, 0x00})) ==
+                                   from({0x01, 0x01, 0x01, 0x00}));
+                      test::expect(encoded(from({0x11, 0x22, 0x00, 0x33})) ==
+                                   from({0x03, 0x11, 0x22, 0x02, 0x33, 0x00}));
+                      test::expect(encoded(from({0x11, 0x00, 0x00, 0x00})) ==
+                                   from({0x02, 0x11, 0x01, 0x01, 0x01, 0x00}));
+                  }},
+  test::test_case{"COBS blocks of 254 bytes",
+                  [] {
+                      std::vector<std::byte> data(255);
+                      for (std::size_t i = 0; i < data.size(); ++i) {
+                          data[i] = static_cast<std::byte>(i + 1);
+                      }
+
+                      // 01..fe: a single full block
+                      auto output =
+                        encoded(std::span{data}.first(254));
+                      test::expect_eq(output.size(), 256U);
+                      test::expect_eq(output.front(), std::byte{0xff});
+                      test::expect_eq(output.back(), std::byte{0x00});
+
+                      // 01..ff: a full block and a block of one byte
+                      output = encoded(data);
+                      test::expect_eq(output.size(), 258U);
+                      test::expect_eq(output[255], std::byte{0x02});
+                      test::expect_eq(output[256], std::byte{0xff});
+                  }},
+  test::test_case{"COBS decoding in place",
+                  [] {
+                      std::vector<std::byte> data(600);
+                      for (std::size_t i = 0; i < data.size(); ++i) {
+                          data[i] = static_cast<std::byte>((i * 7) % 13);
+                      }
+                      auto frame = encoded(data);
+                      std::size_t size = 0;
+                      test::expect(framing::cobs::decode_in_place(
+                        std::span{frame}.first(frame.size() - 1), size));
+                      test::expect_eq(size, data.size());
+                      test::expect(std::ranges::equal(
+                        std::span{frame}.first(size), data));
+
+                      auto invalid = from({0x05, 0x11, 0x22});
+                      test::expect(
+                        !framing::cobs::decode_in_place(invalid, size));
+                  }},
+  test::test_case{"scattered parts make a single frame",
+                  [] {
+                      const std::array parts{bytes("head"), bytes("er+da"),
+                                             bytes("ta")};
+                      const std::array whole{bytes("header+data")};
+                      std::array<std::byte, 32> first{};
+                      std::array<std::byte, 32> second{};
+                      const auto size = framing::encode_frame(parts, first);
+                      test::expect_eq(size,
+                                      framing::encode_frame(whole, second));
+                      test::expect(first == second);
+                      test::expect_eq(size, 11U + 2 + 2);
+
+                      std::array<std::byte, 14> short_output{};
+                      test::expect_eq(
+                        framing::encode_frame(parts, short_output), 0U);
+                  }},
+  test::test_case{"the receiver returns valid frames",
+                  [] {
+                      framing::receiver<framing::crc32, 64> link;
+                      std::array<std::byte, 64> stream{};
+                      const std::array first{bytes("one")};
+                      const std::array second{bytes(std::string_view{
+                        "t\0o", 3})};
+                      std::size_t size = framing::encode_frame<framing::crc32>(
+                        first, stream);
+                      // A corrupted frame in between
+                      const std::size_t corrupted = size;
+                      size += framing::encode_frame<framing::crc32>(
+                        first, std::span{stream}.subspan(size));
+                      stream[corrupted + 1] ^= std::byte{1};
+                      size += framing::encode_frame<framing::crc32>(
+                        second, std::span{stream}.subspan(size));
+
+                      std::ranges::copy(std::span{stream}.first(size),
+                                        link.space().begin());
+                      link.commit(size);
+                      std::span<const std::byte> payload;
+                      test::expect(link.next(payload));
+                      test::expect(std::ranges::equal(payload, bytes("one")));
+                      test::expect(link.next(payload));
+                      test::expect(std::ranges::equal(
+                        payload, bytes(std::string_view{"t\0o", 3})));
+                      test::expect(!link.next(payload));
+                      test::expect_eq(link.stats().frames, 2U);
+                      test::expect_eq(link.stats().crc_errors, 1U);
+                  }},
+  test::test_case{"the receiver recovers from an overrun",
+                  [] {
+                      framing::receiver<framing::crc16, 16> link;
+                      std::span<const std::byte> payload;
+                      // A frame longer than the buffer
+                      const std::vector<std::byte> noise(40, std::byte{0x55});
+                      std::size_t offset = 0;
+                      while (offset < noise.size()) {
+                          auto space = link.space();
+                          const auto count =
+                            std::min(space.size(), noise.size() - offset);
+                          std::copy_n(noise.begin() +
+                                        static_cast<std::ptrdiff_t>(offset),
+                                      count,
+                                      space.begin());
+                          link.commit(count);
+                          offset += count;
+                          test::expect(!link.next(payload));
+                      }
+                      std::array<std::byte, 16> frame{};
+                      const std::array parts{bytes("ok")};
+                      frame[0] = framing::cobs::delimiter;
+                      const auto size = framing::encode_frame(
+                        parts, std::span{frame}.subspan(1));
+                      std::ranges::copy(std::span{frame}.first(size + 1),
+                                        link.space().begin());
+                      link.commit(size + 1);
+                      test::expect(link.next(payload));
+                      test::expect(std::ranges::equal(payload, bytes("ok")));
+                      test::expect(link.stats().overruns >= 1);
+                      test::expect_eq(link.stats().malformed, 0U);
+                  }},
+};
+
+}
+
+int main()
+{
+    return test::run(tests);
+}
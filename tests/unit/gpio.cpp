@@ -0,0 +1,128 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <array>
+
+#include "gpio.hpp"
+#include "rp2040_simulator.hpp"
+#include "test.hpp"
+
+namespace {
+
+namespace sim = hwio::simulator;
+
+using platform::pins;
+using platform::registers::gpio_in;
+using platform::registers::gpio_out;
+using platform::registers::gpio_out_xor;
+
+using contiguous_bus =
+  gpio::bus<pins::gpio18, pins::gpio19, pins::gpio20, pins::gpio21>;
+using scattered_bus =
+  gpio::bus<pins::gpio7, pins::gpio2, pins::gpio11, pins::gpio5>;
+using wide_bus = gpio::bus<pins::gpio0,
+                           pins::gpio2,
+                           pins::gpio4,
+                           pins::gpio6,
+                           pins::gpio8,
+                           pins::gpio10>;
+
+static_assert(contiguous_bus::mask == 0x3c0000);
+static_assert(contiguous_bus::spread(0b1010) == (0b1010 << 18));
+static_assert(contiguous_bus::spread(0xff) == contiguous_bus::mask);
+static_assert(scattered_bus::spread(0b0001) == (1 << 7));
+static_assert(scattered_bus::spread(0b1110) == ((1 << 2) | (1 << 11) |
+                                                (1 << 5)));
+static_assert(wide_bus::spread(0b101001) == ((1 << 0) | (1 << 6) | (1 << 10)));
+
+const std::array tests{
+  test::test_case{"bus write is one read and one store, keeps other pins",
+                  [] {
+                      sim::registers().poke(gpio_out::addr, 0x80000003);
+                      contiguous_bus::write(0b0110);
+                      test::expect_eq(sim::registers().peek(gpio_out::addr),
+                                      0x80000003U | (0b0110U << 18));
+                      contiguous_bus::write(0b1001);
+                      test::expect_eq(sim::registers().peek(gpio_out::addr),
+                                      0x80000003U | (0b1001U << 18));
+                      test::expect_eq(
+                        sim::registers().writes(gpio_out_xor::addr), 2U);
+                      test::expect_eq(sim::registers().total_writes(), 2U);
+                      test::expect_eq(sim::registers().reads(gpio_out::addr),
+                                      2U);
+                      test::expect_eq(sim::registers().total_reads(), 2U);
+                  }},
+  test::test_case{"scattered bus uses the lookup table",
+                  [] {
+                      sim::registers().poke(gpio_out::addr, 0xffffffff);
+                      scattered_bus::write(0b0101);
+                      test::expect_eq(sim::registers().peek(gpio_out::addr),
+                                      ~((1U << 2) | (1U << 5)));
+                  }},
+  test::test_case{"scanner accepts a change after 4 stable samples",
+                  [] {
+                      gpio::input_scanner scanner{0x1};
+                      constexpr std::array samples{0x5U, 0x1U, 0x5U, 0x5U,
+                                                   0x5U};
+                      for (auto sample : samples) {
+                          scanner.update(sample);
+                          test::expect_eq(scanner.state(), 0x1U);
+                      }
+                      scanner.update(0x5);
+                      test::expect_eq(scanner.state(), 0x5U);
+                      test::expect_eq(scanner.rising(), 0x4U);
+                      test::expect_eq(scanner.falling(), 0x0U);
+                      test::expect(scanner.rose(pins::gpio2));
+                      scanner.update(0x5);
+                      test::expect_eq(scanner.rising(), 0x0U);
+                  }},
+  test::test_case{"scanner reports falling edges of all pins at once",
+                  [] {
+                      gpio::input_scanner scanner{0x3fffffff};
+                      for (int sample = 0; sample < 4; ++sample) {
+                          scanner.update(0x00000f0f);
+                      }
+                      test::expect_eq(scanner.state(), 0x00000f0fU);
+                      test::expect_eq(scanner.falling(), 0x3ffff0f0U);
+                      test::expect(scanner.fell(pins::gpio29));
+                      test::expect(scanner.is_high(pins::gpio11));
+                  }},
+  test::test_case{"scanner samples all inputs with a single read",
+                  [] {
+                      gpio::input_scanner scanner;
+                      sim::registers().poke(gpio_in::addr, 0x100);
+                      for (int sample = 0; sample < 4; ++sample) {
+                          scanner.scan();
+                      }
+                      test::expect(scanner.is_high(pins::gpio8));
+                      test::expect_eq(sim::registers().reads(gpio_in::addr),
+                                      4U);
+                      test::expect(gpio::is_high(pins::gpio8));
+                  }},
+};
+
+}
+
+int main()
+{
+    return test::run(tests, rp2040_simulator::setup);
+}
@@ -0,0 +1,120 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <array>
+
+#include "gpio_interrupts.hpp"
+#include "irq.hpp"
+#include "rp2040_simulator.hpp"
+#include "test.hpp"
+
+namespace {
+
+namespace sim = hwio::simulator;
+
+using platform::pins;
+using namespace platform::registers;
+
+struct calls
+{
+    unsigned int count = 0;
+    platform::reg_val_t events = 0;
+};
+
+std::array<calls, 3> handled{};
+
+template<std::size_t Index>
+void record(platform::reg_val_t events)
+{
+    ++handled[Index].count;
+    handled[Index].events = events;
+}
+
+using gpio::irq_events;
+
+using dispatcher = gpio::interrupt_dispatcher<
+  gpio::interrupt_handler<gpio::pin<pins::gpio2>,
+                          record<0>,
+                          irq_events::edge_high>,
+  gpio::interrupt_handler<gpio::pin<pins::gpio5>,
+                          record<1>,
+                          irq_events::edge_low,
+                          irq_events::edge_high>,
+  gpio::interrupt_handler<gpio::pin<pins::gpio20>,
+                          record<2>,
+                          irq_events::level_low>>;
+
+const std::array tests{
+  test::test_case{"enable selects the events of the handled pins",
+                  [] {
+                      dispatcher::enable();
+                      test::expect_eq(
+                        sim::registers().peek(gpio_proc0_inte<0>::addr),
+                        (0x8U << 8) | (0xcU << 20));
+                      test::expect_eq(
+                        sim::registers().peek(gpio_proc0_inte<2>::addr),
+                        0x1U << 16);
+                      test::expect_eq(sim::registers().writes(
+                                        gpio_proc0_inte<1>::addr),
+                                      0U);
+                      test::expect(
+                        irq::is_enabled(platform::irqs::io_irq_bank0));
+                  }},
+  test::test_case{"dispatch calls the handlers of the pending pins only",
+                  [] {
+                      handled = {};
+                      sim::registers().poke(gpio_proc0_ints<0>::addr,
+                                            (0x4U << 20) | (0x1U << 4));
+                      sim::registers().poke(gpio_proc0_ints<2>::addr,
+                                            0x1U << 16);
+                      dispatcher::dispatch();
+                      test::expect_eq(handled[0].count, 0U);
+                      test::expect_eq(handled[1].count, 1U);
+                      test::expect_eq(handled[1].events, 0x4U);
+                      test::expect_eq(handled[2].count, 1U);
+                      test::expect_eq(handled[2].events, 0x1U);
+                  }},
+  test::test_case{"dispatch acknowledges the edges with a single store",
+                  [] {
+                      sim::registers().poke(gpio_proc0_ints<0>::addr,
+                                            (0x8U << 8) | (0x8U << 20));
+                      sim::registers().poke(gpio_proc0_ints<2>::addr,
+                                            0x1U << 16);
+                      dispatcher::dispatch();
+                      test::expect_eq(
+                        sim::registers().writes(gpio_intr<0>::addr), 1U);
+                      test::expect_eq(
+                        sim::registers().peek(gpio_intr<0>::addr),
+                        (0x8U << 8) | (0x8U << 20));
+                      test::expect_eq(
+                        sim::registers().writes(gpio_intr<2>::addr), 0U);
+                      test::expect_eq(
+                        sim::registers().reads(gpio_proc0_ints<1>::addr), 0U);
+                  }},
+};
+
+}
+
+int main()
+{
+    return test::run(tests, rp2040_simulator::setup);
+}
@@ -0,0 +1,129 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <array>
+
+#include "block_store.hpp"
+#include "rp2040_simulator.hpp"
+#include "test.hpp"
+
+namespace {
+
+namespace sim = hwio::simulator;
+
+using uart = platform::uart::uart0;
+using namespace platform::uart;
+
+const std::array tests{
+  test::test_case{
+    "set_value is a single store",
+    [] {
+        uart::uartibrd::set_value(0x1234);
+        test::expect_eq(sim::registers().peek(uart::uartibrd::addr), 0x1234U);
+        test::expect_eq(sim::registers().total_reads(), 0U);
+        test::expect_eq(sim::registers().total_writes(), 1U);
+    }},
+  test::test_case{
+    "update_regions is a single read-modify-write",
+    [] {
+        sim::registers().poke(uart::uartlcr_h::addr, 0xff);
+        uart::uartlcr_h::update_regions(
+          uartlcr_h_region_wlen{uartlcr_h_region_wlen_values::word_5_bits},
+          uartlcr_h_region_stop_bits{uartlcr_h_region_stop_bits_values::one});
+        test::expect_eq(sim::registers().peek(uart::uartlcr_h::addr), 0x97U);
+        test::expect_eq(sim::registers().reads(uart::uartlcr_h::addr), 1U);
+        test::expect_eq(sim::registers().writes(uart::uartlcr_h::addr), 1U);
+    }},
+  test::test_case{
+    "get_bit reads the register once",
+    [] {
+        sim::registers().poke(uart::uartfr::addr, 1U << 5);
+        test::expect(uart::uartfr::get_bit(uartfr_bits::txff));
+        test::expect(!uart::uartfr::get_bit(uartfr_bits::rxfe));
+        test::expect_eq(sim::registers().reads(uart::uartfr::addr), 2U);
+    }},
+  test::test_case{
+    "read_regions decodes all regions from a single read",
+    [] {
+        sim::registers().poke(uart::uartlcr_h::addr, 0x4c);
+        const auto [wlen, parity, stop_bits] =
+          uart::uartlcr_h::read_regions<uartlcr_h_region_wlen,
+                                        uartlcr_h_region_parity,
+                                        uartlcr_h_region_stop_bits>();
+        test::expect_eq(wlen, uartlcr_h_region_wlen_values::word_7_bits);
+        test::expect_eq(parity, uartlcr_h_region_parity_values::even);
+        test::expect_eq(stop_bits, uartlcr_h_region_stop_bits_values::two);
+        test::expect_eq(sim::registers().reads(uart::uartlcr_h::addr), 1U);
+    }},
+  test::test_case{
+    "read_bits decodes all bits from a single read",
+    [] {
+        sim::registers().poke(uart::uartfr::addr, (1U << 5) | (1U << 3));
+        const auto [txff, rxfe, busy] = uart::uartfr::read_bits(
+          uartfr_bits::txff, uartfr_bits::rxfe, uartfr_bits::busy);
+        test::expect(txff && !rxfe && busy);
+        test::expect_eq(sim::registers().reads(uart::uartfr::addr), 1U);
+    }},
+  test::test_case{
+    "atomic operations do not read the register",
+    [] {
+        sim::registers().poke(uart::uartcr::addr, 0x300);
+        uart::uartcr::atomic_set_bits(uartcr_bits::uarten);
+        test::expect_eq(sim::registers().peek(uart::uartcr::addr), 0x301U);
+        uart::uartcr::atomic_clear_bits(uartcr_bits::txe);
+        test::expect_eq(sim::registers().peek(uart::uartcr::addr), 0x201U);
+        uart::uartcr::atomic_toggle(uartcr_bits::uarten);
+        test::expect_eq(sim::registers().peek(uart::uartcr::addr), 0x200U);
+        test::expect_eq(sim::registers().total_reads(), 0U);
+        test::expect_eq(sim::registers().writes(uart::uartcr::addr), 3U);
+    }},
+  test::test_case{
+    "atomic_update_regions keeps the other bits",
+    [] {
+        sim::registers().poke(uart::uartlcr_h::addr, 0xff);
+        uart::uartlcr_h::atomic_update_regions(
+          uartlcr_h_region_wlen{uartlcr_h_region_wlen_values::word_6_bits});
+        test::expect_eq(sim::registers().peek(uart::uartlcr_h::addr), 0xbfU);
+        test::expect_eq(sim::registers().total_reads(), 0U);
+        test::expect_eq(sim::registers().writes(uart::uartlcr_h::addr), 2U);
+    }},
+  test::test_case{
+    "block_store falls back to separate stores",
+    [] {
+        hwio::block_store<uart::uartibrd, uart::uartfbrd, uart::uartlcr_h>::
+          store(1, 2, 3);
+        test::expect_eq(sim::registers().peek(uart::uartibrd::addr), 1U);
+        test::expect_eq(sim::registers().peek(uart::uartfbrd::addr), 2U);
+        test::expect_eq(sim::registers().peek(uart::uartlcr_h::addr), 3U);
+        hwio::block_store<uart::uartibrd, uart::uartlcr_h>::store_same(7);
+        test::expect_eq(sim::registers().peek(uart::uartibrd::addr), 7U);
+        test::expect_eq(sim::registers().peek(uart::uartlcr_h::addr), 7U);
+        test::expect_eq(sim::registers().total_reads(), 0U);
+        test::expect_eq(sim::registers().total_writes(), 5U);
+    }},
+};
+
+}
+
+int main()
+{
+    return test::run(tests, rp2040_simulator::setup);
+}
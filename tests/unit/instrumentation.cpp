@@ -0,0 +1,139 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include "hwio_instrumentation.hpp"
+#include "rp2040_simulator.hpp"
+#include "test.hpp"
+
+namespace {
+
+namespace sim = hwio::simulator;
+namespace instrumentation = hwio::instrumentation;
+
+using recorder = instrumentation::recorder<4, 4>;
+using backend = hwio::
+  instrumented<hwio::simulated, recorder, instrumentation::sequence_clock>;
+
+template<std::uint32_t Offset>
+using test_reg = hwio::rw<hwio::volatile_reg<std::uint32_t,
+                                             std::uint32_t,
+                                             0x40034000,
+                                             Offset,
+                                             unsigned int,
+                                             backend>,
+                          platform::atomic_aliases_for<0x40034000>>;
+
+using reg_a = test_reg<0x00>;
+using reg_b = test_reg<0x04>;
+
+const instrumentation::register_counters* find_counters(std::uint32_t addr)
+{
+    for (const auto& counters : recorder::counters()) {
+        if (counters.addr == addr) {
+            return &counters;
+        }
+    }
+    return nullptr;
+}
+
+struct string_output
+{
+    std::string& text;
+
+    void putc(char character) const
+    {
+        text.push_back(character);
+    }
+};
+
+const std::array tests{
+  test::test_case{
+    "accesses are counted per register",
+    [] {
+        reg_a::set_value(1);
+        reg_a::set_bits(1U);
+        reg_b::value();
+        const auto* a = find_counters(reg_a::addr);
+        const auto* b = find_counters(reg_b::addr);
+        test::expect(a != nullptr && b != nullptr, "(counters allocated)");
+        test::expect_eq(a->reads, 1U);
+        test::expect_eq(a->writes, 2U);
+        test::expect_eq(b->reads, 1U);
+        test::expect_eq(b->writes, 0U);
+    }},
+  test::test_case{
+    "atomic aliases are recorded with the alias address",
+    [] {
+        reg_a::atomic_set_bits(3U);
+        test::expect(find_counters(reg_a::addr + 0x2000) != nullptr);
+        test::expect_eq(sim::registers().peek(reg_a::addr), 0x8U);
+    }},
+  test::test_case{
+    "trace keeps the most recent accesses",
+    [] {
+        for (std::uint32_t i = 0; i < 6; ++i) {
+            reg_b::set_value(i);
+        }
+        test::expect_eq(recorder::trace_size(), 4U);
+        test::expect_eq(recorder::trace_dropped(), 2U);
+        test::expect_eq(recorder::trace_at(0).value, 2U);
+        test::expect_eq(recorder::trace_at(3).value, 5U);
+        test::expect_eq(recorder::trace_at(3).kind,
+                        instrumentation::access::write);
+        test::expect_eq(recorder::trace_at(3).timestamp,
+                        recorder::trace_at(2).timestamp + 1);
+    }},
+  test::test_case{
+    "registers above the capacity are untracked",
+    [] {
+        test_reg<0x08>::value();
+        test_reg<0x0c>::value();
+        test_reg<0x10>::value();
+        test_reg<0x14>::value();
+        test_reg<0x18>::value();
+        test::expect_eq(recorder::untracked_accesses(), 1U);
+    }},
+  test::test_case{
+    "dump does not record its own accesses",
+    [] {
+        reg_a::value();
+        std::string text;
+        instrumentation::dump<recorder>(string_output{text});
+        test::expect_eq(text.substr(0, 29),
+                        std::string("C 40034000 00000001 00000000\n"));
+        test::expect(text.ends_with("E\n"), "(end marker)");
+        test::expect_eq(recorder::trace_size(), 1U);
+    }},
+};
+
+}
+
+int main()
+{
+    return test::run(tests, [] {
+        rp2040_simulator::setup();
+        recorder::clear();
+    });
+}
@@ -0,0 +1,154 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "logging.hpp"
+#include "rp2040_simulator.hpp"
+#include "test.hpp"
+
+namespace {
+
+struct byte_sink
+{
+    static inline std::vector<std::byte> data;
+
+    static void write(std::span<const std::byte> bytes)
+    {
+        data.insert(data.end(), bytes.begin(), bytes.end());
+    }
+};
+
+uint32_t read_varint(std::span<const std::byte> data, std::size_t& position)
+{
+    uint32_t value = 0;
+    for (unsigned int shift = 0;; shift += 7) {
+        const auto byte = std::to_integer<uint32_t>(data[position++]);
+        value |= (byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+}
+
+using small_log = logging::deferred<32>;
+
+const std::array tests{
+  test::test_case{"varint and zigzag encoding",
+                  [] {
+                      std::array<std::byte, logging::max_varint_size> out{};
+                      test::expect_eq(logging::encode_varint(out.data(), 0),
+                                      1U);
+                      test::expect_eq(logging::encode_varint(out.data(), 127),
+                                      1U);
+                      test::expect_eq(logging::encode_varint(out.data(), 300),
+                                      2U);
+                      test::expect_eq(out[0], std::byte{0xac});
+                      test::expect_eq(out[1], std::byte{0x02});
+                      test::expect_eq(
+                        logging::encode_varint(out.data(), 0xffffffff), 5U);
+                      test::expect_eq(logging::zigzag(0), 0U);
+                      test::expect_eq(logging::zigzag(-1), 1U);
+                      test::expect_eq(logging::zigzag(1), 2U);
+                      test::expect_eq(logging::zigzag(INT32_MIN),
+                                      0xffffffffU);
+                  }},
+  test::test_case{"messages carry the level and the argument types",
+                  [] {
+                      const auto& entry =
+                        logging::detail::entry<logging::level::warning,
+                                               "{} {} {} {}",
+                                               int16_t,
+                                               uint32_t,
+                                               bool,
+                                               format::fixed<2>>;
+                      test::expect(std::string_view{entry.data()} ==
+                                   "Wiubf2:{} {} {} {}");
+                  }},
+  test::test_case{"a record holds the ID, the arguments and the time",
+                  [] {
+                      byte_sink::data.clear();
+                      small_log::write<logging::level::info, "{} {}">(
+                        -2, 300U);
+                      small_log::write<logging::level::info, "{} {}">(
+                        -2, 300U);
+                      const auto sent = small_log::drain(byte_sink{});
+
+                      const auto& data = byte_sink::data;
+                      test::expect_eq(sent, data.size());
+                      std::size_t position = 0;
+                      const auto first_size = std::to_integer<std::size_t>(
+                        data[position++]);
+                      const uint32_t id = read_varint(data, position);
+                      test::expect_eq(read_varint(data, position), 3U);
+                      test::expect_eq(read_varint(data, position), 300U);
+                      read_varint(data, position);
+                      test::expect_eq(position, first_size + 1);
+
+                      position++;
+                      test::expect_eq(read_varint(data, position), id);
+                      test::expect_eq(read_varint(data, position), 3U);
+                      test::expect_eq(read_varint(data, position), 300U);
+                      // TIMERAWL advances by one on every read
+                      test::expect_eq(read_varint(data, position), 1U);
+                      test::expect_eq(position, data.size());
+                  }},
+  test::test_case{"dropped records are reported",
+                  [] {
+                      const uint32_t dropped_before = small_log::dropped();
+                      for (uint32_t i = 0; i < 10; ++i) {
+                          small_log::write<logging::level::debug, "{}">(i);
+                      }
+                      const uint32_t dropped =
+                        small_log::dropped() - dropped_before;
+                      test::expect(dropped > 0);
+                      test::expect(small_log::pending() <= 32);
+                      small_log::drain(byte_sink{});
+                      test::expect_eq(small_log::pending(), 0U);
+
+                      byte_sink::data.clear();
+                      small_log::write<logging::level::debug, "{}">(10U);
+                      small_log::drain(byte_sink{});
+                      const auto& data = byte_sink::data;
+                      std::size_t position = 1;
+                      const auto& message =
+                        logging::detail::entry<logging::level::warning,
+                                               "{} log records dropped",
+                                               uint32_t>;
+                      test::expect_eq(
+                        read_varint(data, position),
+                        logging::detail::id_of(message.data()));
+                      test::expect_eq(read_varint(data, position), dropped);
+                  }},
+};
+
+}
+
+int main()
+{
+    return test::run(tests, rp2040_simulator::setup);
+}
@@ -0,0 +1,86 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#include <array>
+#include <numeric>
+#include <span>
+
+#include "ring.hpp"
+#include "test.hpp"
+
+namespace {
+
+const std::array tests{
+  test::test_case{"elements come out in order",
+                  [] {
+                      ring::spsc<int, 4> queue;
+                      test::expect(queue.empty());
+                      test::expect(queue.push(1));
+                      test::expect(queue.push(2));
+                      int value = 0;
+                      test::expect(queue.pop(value));
+                      test::expect_eq(value, 1);
+                      test::expect(queue.pop(value));
+                      test::expect_eq(value, 2);
+                      test::expect(!queue.pop(value));
+                  }},
+  test::test_case{"a full ring rejects new elements",
+                  [] {
+                      ring::spsc<int, 4> queue;
+                      for (int i = 0; i < 4; ++i) {
+                          test::expect(queue.push(i));
+                      }
+                      test::expect(queue.full());
+                      test::expect(!queue.push(4));
+                      test::expect_eq(queue.size(), 4U);
+                  }},
+  test::test_case{"bulk operations wrap around the storage",
+                  [] {
+                      ring::spsc<char, 8> queue;
+                      std::array<char, 8> data{};
+                      std::iota(data.begin(), data.end(), 'a');
+                      for (int round = 0; round < 5; ++round) {
+                          test::expect_eq(
+                            queue.push(std::span{data}.first(5)), 5U);
+                          std::array<char, 8> out{};
+                          test::expect_eq(queue.pop(std::span{out}), 5U);
+                          test::expect(std::ranges::equal(
+                            std::span{out}.first(5), std::span{data}.first(5)));
+                      }
+                  }},
+  test::test_case{"bulk push stores what fits",
+                  [] {
+                      ring::spsc<char, 8> queue;
+                      const std::array<char, 12> data{};
+                      test::expect(queue.push('x'));
+                      test::expect_eq(queue.push(std::span{data}), 7U);
+                      test::expect(queue.full());
+                  }},
+};
+
+}
+
+int main()
+{
+    return test::run(tests);
+}
@@ -0,0 +1,107 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <array>
+
+#include "pwm.hpp"
+#include "rp2040_simulator.hpp"
+#include "shadowed.hpp"
+#include "test.hpp"
+
+namespace {
+
+namespace sim = hwio::simulator;
+
+using uart = platform::uart::uart0;
+using namespace platform::uart;
+using lcr_h = hwio::shadowed<uart::uartlcr_h>;
+
+using slice = pwm::shadowed<pwm::slice1>;
+using slice_registers = platform::pwm::ch1;
+
+const std::array tests{
+  test::test_case{
+    "updates are single stores without reads",
+    [] {
+        lcr_h::reset();
+        lcr_h::update_regions(
+          uartlcr_h_region_wlen{uartlcr_h_region_wlen_values::word_8_bits});
+        lcr_h::set_bits(uartlcr_h_bits::fen);
+        lcr_h::reset_bits(uartlcr_h_bits::fen);
+        lcr_h::toggle(uartlcr_h_bits::brk);
+        test::expect_eq(sim::registers().peek(uart::uartlcr_h::addr), 0x61U);
+        test::expect_eq(lcr_h::value(), 0x61U);
+        test::expect_eq(sim::registers().reads(uart::uartlcr_h::addr), 0U);
+        test::expect_eq(sim::registers().writes(uart::uartlcr_h::addr), 4U);
+    }},
+  test::test_case{
+    "sync loads the shadow with a single read",
+    [] {
+        sim::registers().poke(uart::uartlcr_h::addr, 0x70);
+        lcr_h::sync();
+        lcr_h::clear_regions(uartlcr_h_region_wlen{});
+        test::expect_eq(sim::registers().peek(uart::uartlcr_h::addr), 0x10U);
+        test::expect_eq(sim::registers().reads(uart::uartlcr_h::addr), 1U);
+    }},
+  test::test_case{
+    "atomic operations keep the shadow up to date",
+    [] {
+        lcr_h::reset();
+        lcr_h::atomic_set_bits(uartlcr_h_bits::fen, uartlcr_h_bits::pen);
+        lcr_h::atomic_clear_bits(uartlcr_h_bits::pen);
+        test::expect_eq(lcr_h::value(), 0x10U);
+        test::expect_eq(sim::registers().peek(uart::uartlcr_h::addr), 0x10U);
+        test::expect_eq(sim::registers().total_reads(), 0U);
+    }},
+  test::test_case{
+    "strobe bits are written once and not kept in the shadow",
+    [] {
+        using csr = slice::descriptor::csr;
+        using platform::pwm::csr_bits;
+        csr::reset();
+        csr::set_bits(csr_bits::en, csr_bits::ph_adv);
+        test::expect_eq(sim::registers().peek(slice_registers::csr::addr),
+                        0x81U);
+        test::expect_eq(csr::value(), 1U);
+        csr::set_bits(csr_bits::a_inv);
+        test::expect_eq(sim::registers().peek(slice_registers::csr::addr),
+                        0x5U);
+    }},
+  test::test_case{
+    "shadowed pwm slice does not read the registers",
+    [] {
+        slice::set_frequency(1000);
+        slice::set_channel_levels(pwm::channel_a{100});
+        slice::set_channel_levels(pwm::channel_b{200});
+        slice::enable();
+        test::expect_eq(sim::registers().peek(slice_registers::cc::addr),
+                        (200U << 16) | 100U);
+        test::expect_eq(sim::registers().peek(slice_registers::csr::addr), 1U);
+        test::expect_eq(sim::registers().total_reads(), 0U);
+    }},
+};
+
+}
+
+int main()
+{
+    return test::run(tests, rp2040_simulator::setup);
+}
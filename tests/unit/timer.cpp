@@ -0,0 +1,125 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <array>
+#include <chrono>
+
+#include "rp2040_simulator.hpp"
+#include "test.hpp"
+#include "timer.hpp"
+
+namespace {
+
+using namespace std::chrono_literals;
+namespace sim = hwio::simulator;
+
+unsigned int waits = 0;
+
+void count_waits()
+{
+    sim::core::on_wait = [] {
+        ++waits;
+        rp2040_simulator::wait_for_alarm();
+    };
+    waits = 0;
+}
+
+static_assert(std::chrono::is_clock_v<timer::clock>);
+static_assert(timer::is_before(0xfffffff0, 0x10));
+static_assert(!timer::is_before(0x10, 0xfffffff0));
+static_assert(!timer::is_before(5, 5));
+
+const std::array tests{
+  test::test_case{"now() is consistent when the lower word wraps",
+                  [] {
+                      rp2040_simulator::time_us = 0xffffffff;
+                      const auto now = timer::clock::now();
+                      test::expect(now.time_since_epoch().count() >=
+                                   0x100000000LL);
+                  }},
+  test::test_case{"now_latched() reads TIMELR before TIMEHR",
+                  [] {
+                      rp2040_simulator::time_us = 0x1234500000000;
+                      const auto now = timer::clock::now_latched();
+                      test::expect(now.time_since_epoch().count() ==
+                                   0x1234500000000LL);
+                      test::expect_eq(sim::registers().total_reads(), 2U);
+                      test::expect(sim::core::interrupts_enabled);
+                  }},
+  test::test_case{"short deadlines survive the wrap around",
+                  [] {
+                      rp2040_simulator::time_us = 0xffffff00;
+                      const auto deadline = timer::short_deadline::after(512us);
+                      test::expect_eq(deadline.at(), 0x100U);
+                      test::expect(!deadline.has_expired());
+                      test::expect(deadline.remaining() > 500us);
+                      rp2040_simulator::time_us = 0x100000100;
+                      test::expect(deadline.has_expired());
+                      test::expect(deadline.remaining() == 0us);
+                  }},
+  test::test_case{"short delays read the lower word only",
+                  [] {
+                      timer::delay(100us);
+                      test::expect_eq(sim::registers().reads(
+                                        platform::timer::timerawh::addr),
+                                      0U);
+                      test::expect(rp2040_simulator::time_us >= 100U);
+                  }},
+  test::test_case{"long waits sleep until the alarm",
+                  [] {
+                      count_waits();
+                      const auto deadline = timer::ticks_since_start() + 50ms;
+                      timer::sleep_until(deadline);
+                      test::expect(timer::ticks_since_start() >= deadline);
+                      test::expect_eq(waits, 1U);
+                      test::expect(sim::registers().reads(
+                                     platform::timer::timerawl::addr) < 10U);
+                  }},
+  test::test_case{"short waits are spun",
+                  [] {
+                      count_waits();
+                      const auto deadline = timer::ticks_since_start() +
+                                            timer::sleep_spin_threshold / 2;
+                      timer::sleep_until(deadline);
+                      test::expect(timer::ticks_since_start() >= deadline);
+                      test::expect_eq(waits, 0U);
+                  }},
+  test::test_case{"the alarm is released after sleeping",
+                  [] {
+                      timer::sleep_for(1s);
+                      test::expect_eq(
+                        sim::registers().peek(platform::timer::inte::addr),
+                        0U);
+                      test::expect_eq(
+                        sim::registers().peek(platform::timer::intr::addr),
+                        0U);
+                      test::expect(
+                        !irq::is_pending(platform::irqs::timer_irq_3));
+                  }},
+};
+
+}
+
+int main()
+{
+    return test::run(tests, rp2040_simulator::setup);
+}
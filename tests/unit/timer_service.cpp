@@ -0,0 +1,154 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <array>
+#include <chrono>
+#include <vector>
+
+#include "rp2040_simulator.hpp"
+#include "test.hpp"
+#include "timer_service.hpp"
+
+namespace {
+
+using namespace std::chrono_literals;
+namespace sim = hwio::simulator;
+
+using timers = timer::service<0>;
+using deferred_timers = timer::service<1, timer::dispatch::deferred>;
+
+std::vector<int> expired;
+
+template<int Id>
+void record(timer::software_timer&)
+{
+    expired.push_back(Id);
+}
+
+void advance_to(std::chrono::microseconds time)
+{
+    rp2040_simulator::time_us = static_cast<uint64_t>(time.count());
+}
+
+const std::array tests{
+  test::test_case{"timers expire in the order of their deadlines",
+                  [] {
+                      expired.clear();
+                      timer::software_timer first{record<1>};
+                      timer::software_timer second{record<2>};
+                      timer::software_timer third{record<3>};
+                      timers::init();
+                      timers::start(third, 5000us);
+                      timers::start(first, 100us);
+                      timers::start(second, 300us);
+                      advance_to(200us);
+                      timers::handle_alarm();
+                      test::expect(expired == std::vector{1});
+                      advance_to(10000us);
+                      timers::handle_alarm();
+                      test::expect(expired == std::vector{1, 2, 3});
+                      test::expect(!third.is_active());
+                  }},
+  test::test_case{"the alarm is programmed for the next expiry",
+                  [] {
+                      timer::software_timer single{record<1>};
+                      timers::start(single, 10us);
+                      test::expect_eq(sim::registers().peek(
+                                        platform::timer::alarm<0>::addr),
+                                      static_cast<uint64_t>(
+                                        single.deadline().count()));
+                      timers::cancel(single);
+                      test::expect(!single.is_active());
+                  }},
+  test::test_case{"periodic timers do not drift",
+                  [] {
+                      expired.clear();
+                      timer::software_timer periodic{record<1>};
+                      timers::start_periodic(periodic, 1000us);
+                      const auto first_deadline = periodic.deadline();
+                      advance_to(first_deadline + 300us);
+                      timers::handle_alarm();
+                      advance_to(first_deadline + 1900us);
+                      timers::handle_alarm();
+                      test::expect_eq(expired.size(), 2U);
+                      test::expect(periodic.deadline() ==
+                                   first_deadline + 2000us);
+                      timers::cancel(periodic);
+                  }},
+  test::test_case{"cancelled timers do not expire",
+                  [] {
+                      expired.clear();
+                      timer::software_timer kept{record<1>};
+                      timer::software_timer cancelled{record<2>};
+                      timers::start(kept, 50us);
+                      timers::start(cancelled, 50us);
+                      timers::cancel(cancelled);
+                      advance_to(1000us);
+                      timers::handle_alarm();
+                      test::expect(expired == std::vector{1});
+                  }},
+  test::test_case{"far deadlines wait on the overflow list",
+                  [] {
+                      expired.clear();
+                      timer::software_timer near{record<1>};
+                      timer::software_timer far{record<2>};
+                      timers::start(far, 40min);
+                      timers::start(near, 1min);
+                      advance_to(30min);
+                      timers::handle_alarm();
+                      test::expect(expired == std::vector{1});
+                      advance_to(40min - 10us);
+                      timers::handle_alarm();
+                      test::expect(expired == std::vector{1});
+                      advance_to(41min);
+                      timers::handle_alarm();
+                      test::expect(expired == std::vector{1, 2});
+                  }},
+  test::test_case{"deferred callbacks are called by poll",
+                  [] {
+                      expired.clear();
+                      timer::software_timer deferred{record<1>};
+                      deferred_timers::init();
+                      deferred_timers::start(deferred, 20us);
+                      advance_to(100us);
+                      deferred_timers::handle_alarm();
+                      test::expect(expired.empty());
+                      test::expect(deferred.is_active());
+                      deferred_timers::poll();
+                      test::expect(expired == std::vector{1});
+                      test::expect(!deferred.is_active());
+                  }},
+  test::test_case{"interrupts are masked while the wheel is modified",
+                  [] {
+                      timer::software_timer single{record<1>};
+                      timers::start(single, 10us);
+                      timers::cancel(single);
+                      test::expect(sim::core::interrupts_enabled);
+                  }},
+};
+
+}
+
+int main()
+{
+    return test::run(tests, rp2040_simulator::setup);
+}
@@ -0,0 +1,97 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "rp2040_simulator.hpp"
+#include "test.hpp"
+
+namespace {
+
+namespace sim = hwio::simulator;
+
+using uart = platform::uart::uart0;
+using namespace platform::uart;
+
+const std::array tests{
+  test::test_case{
+    "edits of a register are merged into a single read-modify-write",
+    [] {
+        sim::registers().poke(uart::uartlcr_h::addr, 0x80);
+        hwio::transaction{
+          hwio::op::update_regions<uart::uartlcr_h>(
+            uartlcr_h_region_wlen{uartlcr_h_region_wlen_values::word_8_bits}),
+          hwio::op::set_bits<uart::uartlcr_h>(uartlcr_h_bits::fen),
+          hwio::op::set_bits<uart::uartcr>(uartcr_bits::uarten),
+          hwio::op::reset_bits<uart::uartlcr_h>(uartlcr_h_bits::sps)}
+          .commit();
+        test::expect_eq(sim::registers().peek(uart::uartlcr_h::addr), 0x70U);
+        test::expect_eq(sim::registers().peek(uart::uartcr::addr), 0x1U);
+        test::expect_eq(sim::registers().reads(uart::uartlcr_h::addr), 1U);
+        test::expect_eq(sim::registers().writes(uart::uartlcr_h::addr), 1U);
+        test::expect_eq(sim::registers().reads(uart::uartcr::addr), 1U);
+        test::expect_eq(sim::registers().writes(uart::uartcr::addr), 1U);
+    }},
+  test::test_case{
+    "a full overwrite does not read the register",
+    [] {
+        hwio::transaction{hwio::op::set_value<uart::uartibrd>(813U),
+                          hwio::op::set_value<uart::uartfbrd>(51U)}
+          .commit();
+        test::expect_eq(sim::registers().peek(uart::uartibrd::addr), 813U);
+        test::expect_eq(sim::registers().peek(uart::uartfbrd::addr), 51U);
+        test::expect_eq(sim::registers().total_reads(), 0U);
+        test::expect_eq(sim::registers().total_writes(), 2U);
+    }},
+  test::test_case{
+    "ordering points are respected",
+    [] {
+        std::vector<sim::address_t> order;
+        const auto record = [&order](sim::address_t addr, sim::value_t) {
+            order.push_back(addr);
+        };
+        sim::registers().on_write(uart::uartcr::addr, record);
+        sim::registers().on_write(uart::uartibrd::addr, record);
+        hwio::transaction{
+          hwio::op::set_bits<uart::uartcr>(uartcr_bits::uarten),
+          hwio::ordered,
+          hwio::op::set_value<uart::uartibrd>(1U),
+          hwio::ordered,
+          hwio::op::set_bits<uart::uartcr>(uartcr_bits::txe)}
+          .commit();
+        test::expect_eq(order.size(), 3U);
+        test::expect(order ==
+                     std::vector<sim::address_t>{uart::uartcr::addr,
+                                                 uart::uartibrd::addr,
+                                                 uart::uartcr::addr},
+                     "(order of writes)");
+        test::expect_eq(sim::registers().peek(uart::uartcr::addr), 0x101U);
+    }},
+};
+
+}
+
+int main()
+{
+    return test::run(tests, rp2040_simulator::setup);
+}
@@ -0,0 +1,315 @@
+/*
+ *
+ * Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+ *
+ * Author: Patryk Jaworski <regalis@regalis.tech>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#include <array>
+#include <deque>
+#include <string>
+#include <string_view>
+
+#include "rp2040_simulator.hpp"
+#include "test.hpp"
+#include "uart.hpp"
+
+namespace {
+
+namespace sim = hwio::simulator;
+using namespace platform::uart;
+using registers = uart0;
+using serial = uart::buffered<uart::uart0, 16, 8>;
+using flow_controlled = uart::buffered<uart::uart0_rts_cts, 16, 8>;
+
+constexpr std::size_t fifo_size = 32;
+
+// A minimalistic model of the PL011 FIFOs (RX entries with the error bits)
+std::deque<sim::value_t> rx_fifo;
+std::string transmitted;
+std::size_t tx_fifo_space = fifo_size;
+bool tx_fifo_overflow = false;
+// The transmitter empties the TX FIFO between two status checks
+bool tx_instant_drain = false;
+
+sim::value_t flags()
+{
+    if (tx_instant_drain) {
+        tx_fifo_space = fifo_size;
+    }
+    return (rx_fifo.empty() ? bitmask(uartfr_bits::rxfe) : 0) |
+           (rx_fifo.size() >= fifo_size ? bitmask(uartfr_bits::rxff) : 0) |
+           (tx_fifo_space == 0 ? bitmask(uartfr_bits::txff) : 0) |
+           (tx_fifo_space == fifo_size ? bitmask(uartfr_bits::txfe) : 0);
+}
+
+// RX at or above 1/2, TX at or below 1/4 (the levels set by init())
+sim::value_t raw_interrupts()
+{
+    return (rx_fifo.size() >= fifo_size / 2 ? bitmask(uartris_bits::rxris)
+                                            : 0) |
+           (rx_fifo.empty() ? 0 : bitmask(uartris_bits::rtris)) |
+           (tx_fifo_space >= fifo_size - (fifo_size / 4)
+              ? bitmask(uartris_bits::txris)
+              : 0);
+}
+
+void setup()
+{
+    rp2040_simulator::setup();
+    rx_fifo.clear();
+    transmitted.clear();
+    tx_fifo_space = fifo_size;
+    tx_fifo_overflow = false;
+    tx_instant_drain = false;
+    // Drop the bytes left in the RX ring by the previous test
+    std::array<char, 8> discard{};
+    serial::read(discard);
+    flow_controlled::read(discard);
+    uart::uart0::reset_stats();
+
+    auto& file = sim::registers();
+    file.on_read(registers::uartfr::addr,
+                 [](sim::address_t, sim::value_t) { return flags(); });
+    file.on_read(registers::uartdr::addr,
+                 [](sim::address_t, sim::value_t) -> sim::value_t {
+                     const auto data = rx_fifo.front();
+                     rx_fifo.pop_front();
+                     return data;
+                 });
+    file.on_write(registers::uartdr::addr,
+                  [](sim::address_t, sim::value_t value) {
+                      transmitted += static_cast<char>(value);
+                      tx_fifo_overflow |= (tx_fifo_space == 0);
+                      tx_fifo_space -= (tx_fifo_space > 0) ? 1 : 0;
+                  });
+    file.on_read(registers::uartris::addr,
+                 [](sim::address_t, sim::value_t) { return raw_interrupts(); });
+    file.on_read(registers::uartmis::addr, [](sim::address_t, sim::value_t) {
+        return raw_interrupts() &
+               sim::registers().peek(registers::uartimsc::addr);
+    });
+    serial::init(115200);
+}
+
+void receive(std::string_view data)
+{
+    for (const char character : data) {
+        rx_fifo.push_back(static_cast<unsigned char>(character));
+    }
+}
+
+bool tx_interrupt_enabled()
+{
+    return registers::uartimsc::get_bit(uartimsc_bits::txim);
+}
+
+const std::string long_text =
+  "The quick brown fox jumps over the lazy dog, twice: "
+  "The quick brown fox jumps over the lazy dog";
+
+const std::array tests{
+  test::test_case{"init enables the FIFOs and sets the trigger levels",
+                  [] {
+                      test::expect(
+                        registers::uartlcr_h::get_bit(uartlcr_h_bits::fen));
+                      // TX at 1/4, RX at 1/2
+                      test::expect_eq(
+                        sim::registers().peek(registers::uartifls::addr),
+                        0x11U);
+                  }},
+  test::test_case{"write fills the whole FIFO per status check",
+                  [] {
+                      tx_instant_drain = true;
+                      uart::uart0::write(std::as_bytes(std::span{long_text}));
+                      test::expect(transmitted == long_text);
+                      test::expect(!tx_fifo_overflow);
+                      test::expect_eq(
+                        sim::registers().reads(registers::uartfr::addr),
+                        (long_text.size() + fifo_size - 1) / fifo_size);
+                  }},
+  test::test_case{"puts waits for the FIFO to drain",
+                  [] {
+                      tx_fifo_space = fifo_size - 1;
+                      std::size_t checks = 0;
+                      sim::registers().on_read(
+                        registers::uartfr::addr,
+                        [&checks](sim::address_t, sim::value_t) {
+                            if (++checks == 3) {
+                                tx_fifo_space = fifo_size;
+                            }
+                            return flags();
+                        });
+                      uart::uart0::puts("hi");
+                      test::expect(transmitted == "hi");
+                      test::expect_eq(checks, 3U);
+                  }},
+  test::test_case{"read_some reads a full FIFO in one burst",
+                  [] {
+                      receive(long_text);
+                      std::array<std::byte, 128> received{};
+                      const auto count =
+                        uart::uart0::read_some(std::span{received});
+                      test::expect_eq(count, long_text.size());
+                      test::expect(std::ranges::equal(
+                        std::span{received}.first(count),
+                        std::as_bytes(std::span{long_text})));
+                      // 32 and 32 (full), 16 (at the trigger level), then
+                      // one by one until empty
+                      const auto remainder = long_text.size() - 32 - 32 - 16;
+                      test::expect_eq(
+                        sim::registers().reads(registers::uartfr::addr),
+                        3 + remainder + 1);
+                  }},
+  test::test_case{"read_some does not wait",
+                  [] {
+                      std::array<std::byte, 4> received{};
+                      test::expect_eq(
+                        uart::uart0::read_some(std::span{received}), 0U);
+                      receive("ab");
+                      test::expect_eq(
+                        uart::uart0::read_some(std::span{received}), 2U);
+                  }},
+  test::test_case{"init enables the RX interrupts",
+                  [] {
+                      serial::init(115200);
+                      test::expect(
+                        registers::uartimsc::get_bit(uartimsc_bits::rxim));
+                      test::expect(
+                        registers::uartimsc::get_bit(uartimsc_bits::rtim));
+                      test::expect(!tx_interrupt_enabled());
+                      test::expect(irq::is_enabled(platform::irqs::uart0_irq));
+                  }},
+  test::test_case{"short writes go straight to the FIFO",
+                  [] {
+                      test::expect_eq(
+                        serial::write(std::string_view{"hello"}), 5U);
+                      test::expect(transmitted == "hello");
+                      test::expect(!tx_interrupt_enabled());
+                  }},
+  test::test_case{"the interrupt drains the TX ring",
+                  [] {
+                      tx_fifo_space = 2;
+                      test::expect_eq(
+                        serial::write(std::string_view{"abcdef"}), 6U);
+                      test::expect(transmitted == "ab");
+                      test::expect(tx_interrupt_enabled());
+
+                      tx_fifo_space = fifo_size;
+                      serial::handle_interrupt();
+                      test::expect(transmitted == "abcdef");
+                      test::expect(!tx_interrupt_enabled());
+                      test::expect(!tx_fifo_overflow);
+                  }},
+  test::test_case{"bytes which do not fit are dropped",
+                  [] {
+                      tx_fifo_space = 0;
+                      const auto before = serial::dropped();
+                      test::expect_eq(
+                        serial::write(
+                          std::string_view{"0123456789abcdefXYZ"}), 16U);
+                      test::expect_eq(serial::dropped() - before, 3U);
+                      tx_fifo_space = fifo_size;
+                      serial::handle_interrupt();
+                      test::expect(transmitted == "0123456789abcdef");
+                  }},
+  test::test_case{"received bytes are buffered",
+                  [] {
+                      receive("rx");
+                      serial::handle_interrupt();
+                      test::expect(rx_fifo.empty());
+                      test::expect_eq(serial::available(), 2U);
+                      std::array<char, 4> received{};
+                      test::expect_eq(serial::read(received), 2U);
+                      test::expect(std::string_view{received.data(), 2} ==
+                                   "rx");
+                  }},
+  test::test_case{"receive errors are counted",
+                  [] {
+                      receive("a");
+                      rx_fifo.push_back('b' | bitmask(uartdr_bits::fe));
+                      rx_fifo.push_back('c' | bitmask(uartdr_bits::pe,
+                                                      uartdr_bits::oe));
+                      rx_fifo.push_back(bitmask(uartdr_bits::be,
+                                                uartdr_bits::fe));
+                      std::array<std::byte, 8> received{};
+                      test::expect_eq(
+                        uart::uart0::read_some(std::span{received}), 4U);
+                      test::expect_eq(received[2], std::byte{'c'});
+                      const auto stats = uart::uart0::stats();
+                      test::expect_eq(stats.framing_errors, 2U);
+                      test::expect_eq(stats.parity_errors, 1U);
+                      test::expect_eq(stats.overrun_errors, 1U);
+                      test::expect_eq(stats.break_errors, 1U);
+                      uart::uart0::reset_stats();
+                      test::expect_eq(uart::uart0::stats().framing_errors,
+                                      0U);
+                  }},
+  test::test_case{"flow control is enabled on request",
+                  [] {
+                      test::expect(
+                        !registers::uartcr::get_bit(uartcr_bits::rtsen));
+                      test::expect(
+                        !registers::uartcr::get_bit(uartcr_bits::ctsen));
+                      flow_controlled::init(115200);
+                      test::expect(
+                        registers::uartcr::get_bit(uartcr_bits::rtsen));
+                      test::expect(
+                        registers::uartcr::get_bit(uartcr_bits::ctsen));
+                      test::expect(
+                        registers::uartcr::get_bit(uartcr_bits::uarten));
+                  }},
+  test::test_case{"RTS flow control keeps the bytes in the FIFO",
+                  [] {
+                      flow_controlled::init(115200);
+                      const auto before = flow_controlled::dropped();
+                      receive("0123456789");
+                      flow_controlled::handle_interrupt();
+                      test::expect_eq(flow_controlled::available(), 8U);
+                      test::expect_eq(rx_fifo.size(), 2U);
+                      test::expect(
+                        !registers::uartimsc::get_bit(uartimsc_bits::rxim));
+                      test::expect(
+                        !registers::uartimsc::get_bit(uartimsc_bits::rtim));
+
+                      std::array<char, 4> received{};
+                      test::expect_eq(flow_controlled::read(received), 4U);
+                      test::expect(
+                        registers::uartimsc::get_bit(uartimsc_bits::rtim));
+                      flow_controlled::handle_interrupt();
+                      test::expect(rx_fifo.empty());
+                      test::expect_eq(flow_controlled::available(), 6U);
+                      test::expect_eq(flow_controlled::dropped(), before);
+                  }},
+  test::test_case{"RX overflow is counted",
+                  [] {
+                      const auto before = serial::dropped();
+                      receive("0123456789");
+                      serial::handle_interrupt();
+                      test::expect_eq(serial::available(), 8U);
+                      test::expect_eq(serial::dropped() - before, 2U);
+                  }},
+};
+
+}
+
+int main()
+{
+    return test::run(tests, setup);
+}
@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+#
+# Author: Patryk Jaworski <regalis@regalis.tech>
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+"""COBS framing with CRC-16/32 (host side of src/include/framing.hpp).
+
+A frame is COBS(payload + CRC (little-endian)) followed by a zero byte.
+
+As a library:
+    import framing
+    port.write(framing.encode_frame(b'payload'))
+    reader = framing.FrameReader()
+    for payload in reader.feed(port.read(4096)):
+        ...
+
+As a tool (prints the payload of every frame in hex):
+    $ stty -F /dev/ttyACM0 115200 raw && tools/framing.py < /dev/ttyACM0
+"""
+
+import argparse
+import binascii
+import sys
+
+DELIMITER = 0
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE."""
+    return binascii.crc_hqx(data, 0xffff)
+
+
+def crc32(data):
+    """CRC-32 (IEEE 802.3, zlib)."""
+    return binascii.crc32(data) & 0xffffffff
+
+
+CHECKSUMS = {'crc16': (crc16, 2), 'crc32': (crc32, 4)}
+
+
+def cobs_encode(data):
+    """Encode the data (without the delimiter)."""
+    output = bytearray()
+    block = bytearray()
+    is_open = True
+    for byte in data:
+        is_open = True
+        if byte == DELIMITER:
+            output += bytes([len(block) + 1]) + block
+            block.clear()
+            continue
+        block.append(byte)
+        if len(block) == 254:
+            # A full block, no zero follows it
+            output += b'\xff' + block
+            block.clear()
+            is_open = False
+    if is_open:
+        output += bytes([len(block) + 1]) + block
+    return bytes(output)
+
+
+def cobs_decode(data):
+    """Decode a frame (without the delimiter), ValueError if malformed."""
+    output = bytearray()
+    position = 0
+    while position < len(data):
+        code = data[position]
+        position += 1
+        if code == 0 or position + code - 1 > len(data):
+            raise ValueError('malformed COBS frame')
+        block = data[position:position + code - 1]
+        if DELIMITER in block:
+            raise ValueError('malformed COBS frame')
+        output += block
+        position += code - 1
+        if code != 0xff and position < len(data):
+            output.append(DELIMITER)
+    return bytes(output)
+
+
+def encode_frame(payload, checksum='crc16'):
+    function, size = CHECKSUMS[checksum]
+    data = bytes(payload) + function(payload).to_bytes(size, 'little')
+    return cobs_encode(data) + bytes([DELIMITER])
+
+
+class FrameReader:
+    """Splits a byte stream into frames, counts the errors."""
+
+    def __init__(self, checksum='crc16'):
+        self.function, self.size = CHECKSUMS[checksum]
+        self.buffer = bytearray()
+        self.frames = 0
+        self.crc_errors = 0
+        self.malformed = 0
+
+    def feed(self, data):
+        """Yield the payload of every complete frame with a valid CRC."""
+        self.buffer += data
+        while (end := self.buffer.find(DELIMITER)) >= 0:
+            frame = bytes(self.buffer[:end])
+            del self.buffer[:end + 1]
+            if not frame:
+                continue
+            try:
+                decoded = cobs_decode(frame)
+            except ValueError:
+                self.malformed += 1
+                continue
+            if len(decoded) < self.size:
+                self.malformed += 1
+                continue
+            payload, crc = decoded[:-self.size], decoded[-self.size:]
+            if self.function(payload) != int.from_bytes(crc, 'little'):
+                self.crc_errors += 1
+                continue
+            self.frames += 1
+            yield payload
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('stream', nargs='?', type=argparse.FileType('rb'),
+                        default=sys.stdin.buffer,
+                        help='received bytes (default: standard input)')
+    parser.add_argument('--checksum', choices=sorted(CHECKSUMS),
+                        default='crc16')
+    args = parser.parse_args()
+
+    reader = FrameReader(args.checksum)
+    read = getattr(args.stream, 'read1', args.stream.read)
+    while chunk := read(4096):
+        for payload in reader.feed(chunk):
+            print(payload.hex(' '), flush=True)
+    print(f'{reader.frames} frames, {reader.crc_errors} CRC errors, '
+          f'{reader.malformed} malformed', file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
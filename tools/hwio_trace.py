@@ -0,0 +1,264 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+#
+# Author: Patryk Jaworski <regalis@regalis.tech>
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+"""Pretty printer for the register access statistics.
+
+Decodes the output of hwio::instrumentation::dump() (see
+src/include/hwio_instrumentation.hpp) and maps the register addresses back to
+the names used in rp2040.hpp.
+
+Usage:
+    $ tools/hwio_trace.py uart.log
+    $ picocom -b 115200 /dev/ttyACM0 | tools/hwio_trace.py
+"""
+
+import argparse
+import pathlib
+import re
+import sys
+
+DEFAULT_HEADER = (pathlib.Path(__file__).resolve().parent.parent / 'src' /
+                  'include' / 'rp2040.hpp')
+
+ATOMIC_ALIASES = {1: 'xor', 2: 'set', 3: 'clr'}
+PERIPHERAL_SIZE = 0x4000
+
+IDENTIFIER = re.compile(r'[A-Za-z_]\w*(?:::[A-Za-z_]\w*)*')
+SCOPE = re.compile(
+    r'(template\s*<(?P<params>[^{;]*?)>\s*)?'
+    r'\b(?P<kind>namespace|struct|class)\s+(?P<name>[\w:]*)\s*\{')
+REGISTER = re.compile(
+    r'using\s+(?P<name>\w+)\s*=\s*(?:rw|ro|wo)_reg(?P<direct>_direct)?\s*'
+    r'<(?P<args>.*?)>\s*;',
+    re.S)
+INSTANCE = re.compile(
+    r'using\s+(?P<name>\w+)\s*=\s*(?P<template>[\w:]+)\s*<(?P<args>[^;]*?)>\s*;',
+    re.S)
+CONSTANT = re.compile(
+    r'(?:constexpr\s+static|static\s+constexpr)\s+'
+    r'(?:platform::)?(?:reg_ptr_t|reg_val_t)\s+(?P<name>\w+)\s*=\s*(?P<expr>[^;]+);')
+
+
+def strip_comments(text):
+    text = re.sub(r'/\*.*?\*/', '', text, flags=re.S)
+    return re.sub(r'//[^\n]*', '', text)
+
+
+def split_arguments(args):
+    """Split template arguments on top-level commas."""
+    result, depth, current = [], 0, ''
+    for character in args:
+        if character in '<(':
+            depth += 1
+        elif character in '>)':
+            depth -= 1
+        if character == ',' and depth == 0:
+            result.append(current.strip())
+            current = ''
+        else:
+            current += character
+    if current.strip():
+        result.append(current.strip())
+    return result
+
+
+def template_parameters(params):
+    return [param.split()[-1] for param in split_arguments(params or '')]
+
+
+class Scopes:
+    """Namespace/struct scopes of the header (by position in the text)."""
+
+    def __init__(self, text):
+        self.events = []
+        openings = {match.end() - 1: match for match in SCOPE.finditer(text)}
+        stack = []
+        for position, character in enumerate(text):
+            if character == '{':
+                match = openings.get(position)
+                if match:
+                    stack.append((match.group('name'),
+                                  template_parameters(match.group('params'))))
+                else:
+                    stack.append(None)
+                self.events.append((position, list(stack)))
+            elif character == '}' and stack:
+                stack.pop()
+                self.events.append((position, list(stack)))
+
+    def at(self, position):
+        scopes = []
+        for event_position, stack in self.events:
+            if event_position > position:
+                break
+            scopes = stack
+        return [scope for scope in scopes if scope is not None]
+
+
+def evaluate(expression, constants, environment, depth=0):
+    if depth > 16:
+        raise ValueError(expression)
+
+    def substitute(match):
+        name = match.group(0).split('::')[-1]
+        if name in environment:
+            return '(' + str(evaluate(environment[name], constants, {},
+                                      depth + 1)) + ')'
+        if name in constants:
+            return '(' + str(evaluate(constants[name], constants, environment,
+                                      depth + 1)) + ')'
+        raise ValueError(name)
+
+    expression = re.sub(r'\b(0x[0-9a-fA-F]+|\d+)[uUlL]+\b', r'\1', expression)
+    expression = re.sub(r'(?<![0-9xX])' + IDENTIFIER.pattern, substitute,
+                        expression)
+    if not re.fullmatch(r'[\s0-9a-fA-FxX()+\-*/<>|&]*', expression):
+        raise ValueError(expression)
+    return int(eval(expression, {'__builtins__': {}}))  # noqa: S307
+
+
+def load_register_names(header):
+    text = strip_comments(header.read_text())
+    scopes = Scopes(text)
+    constants = {match.group('name'): match.group('expr')
+                 for match in CONSTANT.finditer(text)}
+
+    names = {}
+    templated = {}
+    for match in REGISTER.finditer(text):
+        args = split_arguments(match.group('args'))
+        scope = scopes.at(match.start())
+        path = '::'.join(name for name, _ in scope)
+        params = [param for _, scope_params in scope for param in scope_params]
+        if params:
+            templated.setdefault(scope[-1][0], []).append(
+                (scope[-1][1], match.group('name'), args))
+            continue
+        try:
+            addr = evaluate(args[0], constants, {})
+            if not match.group('direct'):
+                addr += evaluate(args[1], constants, {})
+        except ValueError:
+            continue
+        names.setdefault(addr, path + '::' + match.group('name'))
+
+    for match in INSTANCE.finditer(text):
+        template = match.group('template').split('::')[-1]
+        if template not in templated:
+            continue
+        args = split_arguments(match.group('args'))
+        path = '::'.join(name for name, _ in scopes.at(match.start()))
+        for params, register, register_args in templated[template]:
+            environment = dict(zip(params, args))
+            try:
+                addr = evaluate(register_args[0], constants, environment) + \
+                    evaluate(register_args[1], constants, environment)
+            except ValueError:
+                continue
+            names.setdefault(addr,
+                             f'{path}::{match.group("name")}::{register}')
+
+    bases = {}
+    for name, expression in constants.items():
+        if name.endswith('_base'):
+            try:
+                bases[evaluate(expression, constants, {})] = name
+            except ValueError:
+                pass
+    return names, bases
+
+
+class Names:
+
+    def __init__(self, header):
+        self.names, self.bases = load_register_names(header)
+
+    def __call__(self, addr):
+        if addr in self.names:
+            return self.names[addr]
+        alias = (addr >> 12) & 0x3
+        target = addr & ~0x3000
+        if 0x40000000 <= addr < 0x60000000 and alias and \
+                target in self.names:
+            return f'{self.names[target]} ({ATOMIC_ALIASES[alias]})'
+        for base in sorted(self.bases, reverse=True):
+            if base <= target < base + PERIPHERAL_SIZE:
+                suffix = f' ({ATOMIC_ALIASES[alias]})' if alias else ''
+                return f'{self.bases[base]}+0x{target - base:x}{suffix}'
+        return f'0x{addr:08x}'
+
+
+def parse_dump(lines):
+    counters, trace, untracked, dropped = [], [], 0, 0
+    for line in lines:
+        fields = line.split()
+        if not fields or fields[0] not in 'CUDTE' or len(fields[0]) != 1:
+            continue
+        try:
+            values = [int(field, 16) for field in fields[1:]]
+        except ValueError:
+            continue
+        if fields[0] == 'C' and len(values) == 3:
+            counters.append(values)
+        elif fields[0] == 'U' and len(values) == 1:
+            untracked = values[0]
+        elif fields[0] == 'D' and len(values) == 1:
+            dropped = values[0]
+        elif fields[0] == 'T' and len(values) == 4:
+            trace.append(values)
+        elif fields[0] == 'E':
+            break
+    return counters, trace, untracked, dropped
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('dump', nargs='?', type=argparse.FileType('r'),
+                        default=sys.stdin,
+                        help='output of hwio::instrumentation::dump()')
+    parser.add_argument('--header', type=pathlib.Path, default=DEFAULT_HEADER,
+                        help='register definitions (default: %(default)s)')
+    parser.add_argument('--no-trace', action='store_true',
+                        help='print the counters only')
+    args = parser.parse_args()
+
+    name = Names(args.header)
+    counters, trace, untracked, dropped = parse_dump(args.dump)
+
+    print(f'{"register":<48} {"reads":>8} {"writes":>8}')
+    for addr, reads, writes in sorted(counters,
+                                      key=lambda c: c[1] + c[2],
+                                      reverse=True):
+        print(f'{name(addr):<48} {reads:>8} {writes:>8}')
+    print(f'{"(untracked)":<48} {untracked:>17}')
+
+    if args.no_trace:
+        return
+    print(f'\ntrace ({len(trace)} entries, {dropped} dropped)')
+    previous = trace[0][0] if trace else 0
+    for timestamp, addr, value, kind in trace:
+        delta = (timestamp - previous) & 0xffffffff
+        previous = timestamp
+        print(f'{timestamp:>10} +{delta:<6} {"W" if kind else "R"} '
+              f'{name(addr):<48} 0x{value:08x}')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,234 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+#
+# Author: Patryk Jaworski <regalis@regalis.tech>
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+"""Decoder of the deferred binary logs.
+
+Looks the messages sent by logging::deferred (see src/include/logging.hpp)
+up in the ELF file of the firmware and prints the formatted text.
+
+Usage:
+    $ tools/log_decode.py build/examples/blink/blink.elf uart.bin
+    $ stty -F /dev/ttyACM0 115200 raw && \\
+        tools/log_decode.py firmware.elf < /dev/ttyACM0
+"""
+
+import argparse
+import decimal
+import re
+import struct
+import sys
+
+ENTRY_PREFIX = '_ZN7logging6detail5entryI'
+ANCHOR = '_ZN7logging6detail6anchorE'
+
+LEVELS = {'D': 'debug', 'I': 'info', 'W': 'warning', 'E': 'error'}
+
+SHT_SYMTAB = 2
+SHN_LORESERVE = 0xff00
+
+TYPE = re.compile(r'f\d|[uicb]')
+FIELD = re.compile(r'\{\{|\}\}|\{(?::(?P<spec>[^}]*))?\}')
+SPEC = re.compile(r'(?P<zero>0)?(?P<width>\d*)(?P<type>[a-zA-Z]?)')
+
+
+class Message:
+
+    def __init__(self, entry):
+        types, _, self.text = entry.partition(':')
+        self.level = LEVELS.get(types[0], types[0])
+        self.types = TYPE.findall(types[1:])
+
+
+class Elf:
+    """The bare minimum of an ELF reader (sections and symbols)."""
+
+    def __init__(self, data):
+        if data[:4] != b'\x7fELF':
+            raise ValueError('not an ELF file')
+        self.data = data
+        is_64 = data[4] == 2
+        self.endian = '<' if data[5] == 1 else '>'
+        if is_64:
+            shoff, = self.unpack('Q', 0x28)
+            shentsize, shnum = self.unpack('HH', 0x3a)
+            self.section_format = 'IIQQQQIIQQ'
+            self.symbol_format = 'IBBHQQ'
+        else:
+            shoff, = self.unpack('I', 0x20)
+            shentsize, shnum = self.unpack('HH', 0x2e)
+            self.section_format = 'IIIIIIIIII'
+            self.symbol_format = 'IIIBBH'
+        self.is_64 = is_64
+        self.sections = [self.unpack(self.section_format,
+                                     shoff + index * shentsize)
+                         for index in range(shnum)]
+
+    def unpack(self, fmt, offset):
+        return struct.unpack_from(self.endian + fmt, self.data, offset)
+
+    def string(self, offset):
+        end = self.data.index(b'\0', offset)
+        return self.data[offset:end].decode(errors='replace')
+
+    def symbols(self):
+        """(name, value, section index) of every symbol."""
+        size = struct.calcsize(self.symbol_format)
+        for section in self.sections:
+            if section[1] != SHT_SYMTAB:
+                continue
+            strings = self.sections[section[6]][4]
+            for offset in range(section[4], section[4] + section[5], size):
+                fields = self.unpack(self.symbol_format, offset)
+                if self.is_64:
+                    name, _, _, shndx, value, _ = fields
+                else:
+                    name, value, _, _, _, shndx = fields
+                yield self.string(strings + name), value, shndx
+
+    def string_at(self, value, shndx):
+        """The NUL-terminated string at the address within the section."""
+        section = self.sections[shndx]
+        return self.string(section[4] + value - section[3])
+
+
+def load_messages(path):
+    with open(path, 'rb') as elf_file:
+        elf = Elf(elf_file.read())
+    anchor, entries = None, []
+    for name, value, shndx in elf.symbols():
+        if shndx == 0 or shndx >= SHN_LORESERVE:
+            continue
+        if name == ANCHOR:
+            anchor = value
+        elif name.startswith(ENTRY_PREFIX):
+            entries.append((value, elf.string_at(value, shndx)))
+    if anchor is None:
+        raise ValueError(f'{path}: no log messages found')
+    return {(value - anchor) & 0xffffffff: Message(entry)
+            for value, entry in entries}
+
+
+def read_varint(record, position):
+    value, shift = 0, 0
+    while True:
+        byte = record[position]
+        position += 1
+        value |= (byte & 0x7f) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value, position
+
+
+def unzigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def format_argument(kind, value, spec):
+    match = SPEC.fullmatch(spec)
+    zero, width, presentation = match.group('zero', 'width', 'type')
+    numeric = (zero or '') + width + presentation
+    if kind == 'c' and presentation in ('', 'c'):
+        return f'{chr(value):<{width or 0}}'
+    if kind == 'b' and presentation in ('', 's'):
+        return f'{"true" if value else "false":<{width or 0}}'
+    if kind == 'i':
+        value = unzigzag(value)
+    if kind.startswith('f'):
+        number = decimal.Decimal(unzigzag(value)).scaleb(-int(kind[1]))
+        return format(number, (zero or '') + width + 'f')
+    return format(value, numeric)
+
+
+def format_message(message, arguments):
+    values = iter(zip(message.types, arguments))
+
+    def substitute(match):
+        if match.group(0) in ('{{', '}}'):
+            return match.group(0)[0]
+        kind, value = next(values)
+        return format_argument(kind, value, match.group('spec') or '')
+
+    return FIELD.sub(substitute, message.text)
+
+
+def decode_record(messages, record):
+    """(message, arguments, timestamp delta) or None if malformed."""
+    try:
+        message_id, position = read_varint(record, 0)
+        message = messages.get(message_id)
+        if message is None:
+            return None
+        arguments = []
+        for _ in message.types:
+            value, position = read_varint(record, position)
+            arguments.append(value)
+        delta, position = read_varint(record, position)
+    except IndexError:
+        return None
+    if position != len(record):
+        return None
+    return message, arguments, delta
+
+
+def decode(messages, stream, output):
+    data = b''
+    time_us = 0
+    skipped = 0
+    # Without waiting for a full buffer (live streams)
+    read = getattr(stream, 'read1', stream.read)
+    while chunk := read(4096):
+        data += chunk
+        position = 0
+        while position < len(data):
+            size = data[position]
+            if position + 1 + size > len(data):
+                break
+            record = data[position + 1:position + 1 + size]
+            decoded = decode_record(messages, record)
+            if decoded is None:
+                # Out of sync (e.g. connected in the middle of a record)
+                position += 1
+                skipped += 1
+                continue
+            message, arguments, delta = decoded
+            time_us += delta
+            text = format_message(message, arguments)
+            output.write(f'[{time_us / 1e6:>12.6f}] {message.level:<7} '
+                         f'{text}\n')
+            output.flush()
+            position += 1 + size
+        data = data[position:]
+    if skipped:
+        output.write(f'({skipped} bytes skipped)\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('elf', help='ELF file of the firmware')
+    parser.add_argument('log', nargs='?', type=argparse.FileType('rb'),
+                        default=sys.stdin.buffer,
+                        help='binary log (default: standard input)')
+    args = parser.parse_args()
+
+    decode(load_messages(args.elf), args.log, sys.stdout)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,221 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2023-2024 Patryk Jaworski (blog.regalis.tech)
+#
+# Author: Patryk Jaworski <regalis@regalis.tech>
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+
+"""Per-function code size and static cycle cost report.
+
+Post-processes the firmware ELF files and writes a JSON report with:
+  * the size of every section,
+  * the size of every symbol,
+  * a static Cortex-M0+ cycle estimate of every function (each instruction
+    executed once, conditional branches assumed taken) and the loops found
+    in it (backward branches) with their cost per iteration.
+
+The estimate uses the Cortex-M0+ instruction timings (Cortex-M0+ Technical
+Reference Manual, table 3.1) with zero wait state memory. Code executed from
+the external flash (XIP) will be slower on a cache miss.
+
+Usage:
+    $ tools/size_report.py --output size-report.json build/*.elf
+"""
+
+import argparse
+import json
+import pathlib
+import re
+import subprocess
+import sys
+
+FUNCTION = re.compile(r'^(?P<addr>[0-9a-f]+) <(?P<name>[^>]+)>:$')
+INSTRUCTION = re.compile(
+    r'^\s*(?P<addr>[0-9a-f]+):\s+(?P<mnemonic>[a-z][\w.]*)\s*(?P<operands>.*)$')
+BRANCH_TARGET = re.compile(r'^(?:0x)?(?P<target>[0-9a-f]+)\s+<')
+SYMBOL = re.compile(
+    r'^(?P<addr>[0-9a-f]+)\s(?P<flags>.{7})\s(?P<section>\S+)\s+'
+    r'(?P<size>[0-9a-f]+)\s+(?P<name>.+)$')
+SECTION = re.compile(
+    r'^\s*\d+\s+(?P<name>\S+)\s+(?P<size>[0-9a-f]+)\s+(?P<vma>[0-9a-f]+)')
+DATA_DIRECTIVES = ('.word', '.short', '.byte')
+
+# Cycles of the Cortex-M0+ instructions (not listed: 1 cycle)
+FIXED_CYCLES = {
+    'ldr': 2, 'ldrb': 2, 'ldrh': 2, 'ldrsb': 2, 'ldrsh': 2,
+    'str': 2, 'strb': 2, 'strh': 2,
+    'b': 2, 'bx': 2, 'blx': 2, 'bl': 3,
+    'mrs': 3, 'msr': 3, 'dsb': 3, 'dmb': 3, 'isb': 3,
+}
+
+
+def register_count(operands):
+    registers = 0
+    for item in re.findall(r'\{([^}]*)\}', operands)[0].split(','):
+        item = item.strip()
+        if '-' in item:
+            first, last = (int(reg.strip()[1:]) for reg in item.split('-'))
+            registers += last - first + 1
+        elif item:
+            registers += 1
+    return registers
+
+
+def instruction_cycles(mnemonic, operands):
+    mnemonic = mnemonic.split('.')[0]
+    if mnemonic in ('push', 'stmia', 'stm', 'ldmia', 'ldm'):
+        return 1 + register_count(operands)
+    if mnemonic == 'pop':
+        registers = register_count(operands)
+        return registers + (3 if 'pc' in operands else 1)
+    if mnemonic in ('mov', 'add') and operands.startswith('pc'):
+        return 2
+    if len(mnemonic) == 3 and mnemonic.startswith('b') and \
+            mnemonic not in ('bic', 'bkpt'):
+        # Conditional branch (assumed taken)
+        return 2
+    return FIXED_CYCLES.get(mnemonic, 1)
+
+
+def run(*command):
+    return subprocess.run(command, check=True, capture_output=True,
+                          text=True).stdout
+
+
+def read_sections(objdump, elf):
+    sections = {}
+    for line in run(objdump, '-h', elf).splitlines():
+        if match := SECTION.match(line):
+            sections[match.group('name')] = int(match.group('size'), 16)
+    return sections
+
+
+def read_symbols(objdump, elf):
+    symbols = {}
+    for line in run(objdump, '-t', '-C', elf).splitlines():
+        match = SYMBOL.match(line)
+        if not match or match.group('section') in ('*ABS*', '*UND*'):
+            continue
+        flags = match.group('flags')
+        kind = 'function' if 'F' in flags else \
+            'object' if 'O' in flags else None
+        size = int(match.group('size'), 16)
+        if kind is None or size == 0:
+            continue
+        # Thumb functions have the lowest bit of the address set
+        addr = int(match.group('addr'), 16) & ~1
+        symbols[(match.group('section'), addr)] = {
+            'name': match.group('name').strip(),
+            'kind': kind,
+            'section': match.group('section'),
+            'addr': f'0x{addr:08x}',
+            'size': size,
+            'binding': 'local' if flags[0] == 'l' else 'global',
+        }
+    return symbols
+
+
+def read_functions(objdump, elf):
+    functions, current, section = {}, None, None
+    for line in run(objdump, '-d', '--no-show-raw-insn', elf).splitlines():
+        if line.startswith('Disassembly of section '):
+            section = line.removeprefix('Disassembly of section ')[:-1]
+        elif match := FUNCTION.match(line):
+            current = functions.setdefault(
+                (section, int(match.group('addr'), 16)), [])
+        elif current is not None and (match := INSTRUCTION.match(line)):
+            mnemonic = match.group('mnemonic')
+            if mnemonic not in DATA_DIRECTIVES:
+                operands = re.split(r'\s+[@;]', match.group('operands'))[0]
+                current.append((int(match.group('addr'), 16), mnemonic,
+                                operands.strip()))
+    return functions
+
+
+def estimate(instructions):
+    cycles = [instruction_cycles(mnemonic, operands)
+              for _, mnemonic, operands in instructions]
+    loops = []
+    for index, (addr, mnemonic, operands) in enumerate(instructions):
+        target = BRANCH_TARGET.match(operands)
+        # Calls (bl/blx) are not loops, bls/blt/ble are conditional branches
+        if not mnemonic.startswith('b') or \
+                mnemonic.split('.')[0] in ('bl', 'blx', 'bic') or not target:
+            continue
+        target_addr = int(target.group('target'), 16)
+        if target_addr > addr:
+            continue
+        first = next((i for i, (a, _, _) in enumerate(instructions)
+                      if a >= target_addr), index)
+        loops.append({
+            'start': f'0x{target_addr:08x}',
+            'end': f'0x{addr:08x}',
+            'instructions': index - first + 1,
+            'cycles_per_iteration': sum(cycles[first:index + 1]),
+        })
+    return {
+        'instructions': len(instructions),
+        'cycles': sum(cycles),
+        'loops': loops,
+    }
+
+
+def report(objdump, elf):
+    symbols = read_symbols(objdump, elf)
+    for key, instructions in read_functions(objdump, elf).items():
+        if key in symbols and symbols[key]['kind'] == 'function':
+            symbols[key].update(estimate(instructions))
+    ordered = sorted(symbols.values(),
+                     key=lambda symbol: (-symbol['size'], symbol['name']))
+    return {
+        'sections': read_sections(objdump, elf),
+        'symbols': ordered,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--objdump', default='arm-none-eabi-objdump')
+    parser.add_argument('--optimization', default='unknown',
+                        help='optimization level (recorded in the report)')
+    parser.add_argument('--output', type=pathlib.Path,
+                        help='JSON report (default: stdout)')
+    parser.add_argument('elf', nargs='+', type=pathlib.Path)
+    args = parser.parse_args()
+
+    result = {
+        'optimization': args.optimization,
+        'targets': {elf.name: report(args.objdump, str(elf))
+                    for elf in args.elf},
+    }
+
+    text = json.dumps(result, indent=2, sort_keys=True) + '\n'
+    if args.output:
+        args.output.write_text(text)
+    else:
+        sys.stdout.write(text)
+
+    for name, target in result['targets'].items():
+        text_size = sum(size for section, size in target['sections'].items()
+                        if section.startswith(('.text', '.boot', '.rodata')))
+        print(f'{name}: {text_size} bytes of code and constants',
+              file=sys.stderr)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())